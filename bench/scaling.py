@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Strong and weak scaling runs of ./main on generated graphs.
+
+Every run uses --generate and --profile, so no input files are needed. For
+each (ranks, threads) pair the table shows the per-phase time of the slowest
+rank, edges per second over the whole run, and the peak RSS of the largest
+rank. Strong scaling keeps the graph fixed; weak scaling adds log2(ranks *
+threads) to the scale so the edges per worker stay constant.
+
+    python3 bench/scaling.py --main src/main --max-ranks 4 --threads 1,2
+    python3 bench/scaling.py --mode weak --scale 14 --json runs.json
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+PHASES = ["load", "supports", "bounds", "partition", "migrate", "local_peel", "refine", "max_truss"]
+
+
+def powers_of_two(limit):
+    values = []
+    p = 1
+    while p <= limit:
+        values.append(p)
+        p *= 2
+    return values
+
+
+def run(args, ranks, threads, scale):
+    with tempfile.TemporaryDirectory() as tmp:
+        profile = os.path.join(tmp, "profile.json")
+        command = ["mpirun", "-np", str(ranks)] + args.mpirun_args.split() + [
+            args.main, "--generate", args.model, "--scale", str(scale),
+            "--edge-factor", str(args.edge_factor), "--reciprocity", str(args.reciprocity),
+            "--rmat", args.rmat, "--seed", str(args.seed), "--threads", str(threads),
+            "--partitioner", args.partitioner, "--profile", profile]
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+        if result.returncode != 0:
+            sys.exit("run failed: " + " ".join(command) + "\n" + result.stderr)
+        match = re.search(r"(\d+) edges", result.stdout)
+        with open(profile) as f:
+            summary = json.load(f)
+
+    phases = {p["name"]: p for p in summary["phases"]}
+    seconds = {name: phases[name]["seconds"]["max"] for name in PHASES if name in phases}
+    return {
+        "ranks": ranks,
+        "threads": threads,
+        "scale": scale,
+        "edges": int(match.group(1)) if match else 0,
+        "seconds": seconds,
+        "total_seconds": sum(seconds.values()),
+        "imbalance": {name: phases[name]["seconds"]["imbalance"] for name in seconds},
+        "peak_rss_kb": {name: phases[name]["peak_rss_kb"]["max"] for name in seconds},
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--main", default="src/main", help="path to the compiled executable")
+    parser.add_argument("--mode", choices=["strong", "weak"], default="strong")
+    parser.add_argument("--model", choices=["rmat", "er"], default="rmat")
+    parser.add_argument("--scale", type=int, default=16, help="log2 vertices (of the 1-worker run for weak scaling)")
+    parser.add_argument("--edge-factor", type=int, default=16)
+    parser.add_argument("--rmat", default="0.57,0.19,0.19", help="R-MAT quadrant probabilities a,b,c")
+    parser.add_argument("--reciprocity", type=float, default=0.2)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--partitioner", choices=["stratified", "type-aware"], default="stratified")
+    parser.add_argument("--max-ranks", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--threads", default="1", help="comma-separated thread counts per rank")
+    parser.add_argument("--mpirun-args", default="--oversubscribe", help="extra mpirun arguments")
+    parser.add_argument("--json", help="also write all runs to this file")
+    args = parser.parse_args()
+
+    runs = []
+    for threads in [int(t) for t in args.threads.split(",")]:
+        for ranks in powers_of_two(args.max_ranks):
+            workers = ranks * threads
+            scale = args.scale + (workers.bit_length() - 1 if args.mode == "weak" else 0)
+            runs.append(run(args, ranks, threads, scale))
+
+    header = "%5s %7s %5s %10s" % ("ranks", "threads", "scale", "edges")
+    header += "".join(" %10s" % name for name in PHASES)
+    header += " %10s %12s %8s %10s" % ("total_s", "edges/s", "eff", "rss_MB")
+    print(header)
+    base = runs[0]
+    for r in runs:
+        workers = r["ranks"] * r["threads"]
+        base_workers = base["ranks"] * base["threads"]
+        if args.mode == "strong":
+            efficiency = base["total_seconds"] * base_workers / (r["total_seconds"] * workers)
+        else:
+            efficiency = base["total_seconds"] / r["total_seconds"]
+        line = "%5d %7d %5d %10d" % (r["ranks"], r["threads"], r["scale"], r["edges"])
+        line += "".join(" %10.4f" % r["seconds"].get(name, 0.0) for name in PHASES)
+        line += " %10.4f %12.0f %8.2f %10.1f" % (r["total_seconds"], r["edges"] / max(r["total_seconds"], 1e-9),
+                                                 efficiency, max(r["peak_rss_kb"].values()) / 1024.0)
+        print(line)
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"mode": args.mode, "model": args.model, "runs": runs}, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
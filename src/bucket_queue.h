@@ -0,0 +1,47 @@
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <vector>
+
+// Support-indexed buckets for peeling. Decrementing an edge re-files it with
+// an O(1) push into its new bucket; the entry left in the old bucket goes
+// stale and is skipped by the caller when that bucket is drained.
+class BucketQueue {
+public:
+    void push(int item, int key) {
+        if (key >= static_cast<int>(bins.size())) {
+            bins.resize(key + 1);
+        }
+        bins[key].push_back(item);
+    }
+
+    // Lowest non-empty bucket at or above level, or -1 if all are empty
+    int next_level(int level) const {
+        for (int k = level < 0 ? 0 : level; k < static_cast<int>(bins.size()); ++k) {
+            if (!bins[k].empty()) {
+                return k;
+            }
+        }
+        return -1;
+    }
+
+    // Empty every bucket, keeping its memory for the next peel
+    void clear() {
+        for (auto& bin : bins) {
+            bin.clear();
+        }
+    }
+
+    // Remove and return the entries of a bucket (none beyond the highest one)
+    void take(int level, std::vector<int>& out) {
+        out.clear();
+        if (level < static_cast<int>(bins.size())) {
+            out.swap(bins[level]);
+        }
+    }
+
+private:
+    std::vector<std::vector<int>> bins;
+};
+
+#endif // BUCKET_QUEUE_H
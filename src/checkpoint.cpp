@@ -0,0 +1,173 @@
+#include "checkpoint.h"
+#include <mpi.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+using namespace std;
+
+static const char CHECKPOINT_MAGIC[8] = {'D', 'D', 'T', 'C', 'K', 'P', 'T', '2'};
+
+struct CheckpointHeader {
+    char magic[8];
+    int32_t rank, size;
+    int32_t stage, superstep, k_c, k_f;
+    int32_t num_vertices, num_edges;
+};
+
+static string slot_path(const string& prefix, int slot, int rank) {
+    return prefix + "." + to_string(slot) + "." + to_string(rank);
+}
+
+// Slot of the last committed checkpoint as seen by rank 0, or -1
+static int committed_slot(const string& prefix, int rank) {
+    int slot = -1;
+    if (rank == 0) {
+        FILE* f = fopen((prefix + ".latest").c_str(), "r");
+        if (f) {
+            int superstep;
+            if (fscanf(f, "%d %d", &slot, &superstep) != 2 || (slot != 0 && slot != 1)) {
+                slot = -1;
+            }
+            fclose(f);
+        }
+    }
+    MPI_Bcast(&slot, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    return slot;
+}
+
+template <typename T>
+static void append_array(vector<char>& out, const vector<T>& values) {
+    const char* p = reinterpret_cast<const char*>(values.data());
+    out.insert(out.end(), p, p + values.size() * sizeof(T));
+}
+
+template <typename T>
+static bool read_array(FILE* f, vector<T>& values, size_t count) {
+    values.resize(count);
+    return fread(values.data(), sizeof(T), count, f) == count;
+}
+
+CheckpointWriter::CheckpointWriter(const string& prefix, int rank, int size) : prefix(prefix), rank(rank), size(size) {
+    // Never overwrite the checkpoint a resumed run started from
+    slot = committed_slot(prefix, rank);
+    if (slot < 0) {
+        slot = 1;
+    }
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void CheckpointWriter::write(const CheckpointInfo& info, const DiGraph& G, const EdgeSupports& supports,
+                             const vector<char>& removed) {
+    commit();
+
+    CheckpointHeader header;
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.rank = rank;
+    header.size = size;
+    header.stage = info.stage;
+    header.superstep = info.superstep;
+    header.k_c = info.k_c;
+    header.k_f = info.k_f;
+    header.num_vertices = G.num_vertices;
+    header.num_edges = G.num_edges();
+
+    buffer.clear();
+    buffer.reserve(sizeof(header) + G.labels.size() * sizeof(VertexId) + (G.num_vertices + 1) * sizeof(int) +
+                   G.num_edges() * (3 * sizeof(int) + 1));
+    const char* p = reinterpret_cast<const char*>(&header);
+    buffer.insert(buffer.end(), p, p + sizeof(header));
+    append_array(buffer, G.labels);
+    append_array(buffer, G.out_offsets);
+    append_array(buffer, G.out_targets);
+    append_array(buffer, supports.cycle);
+    append_array(buffer, supports.flow);
+    append_array(buffer, removed);
+
+    slot ^= 1;
+    superstep = info.superstep;
+    pending = true;
+    string path = slot_path(prefix, slot, rank);
+    writer = thread([this, path]() {
+        FILE* f = fopen(path.c_str(), "wb");
+        ok = f && fwrite(buffer.data(), 1, buffer.size(), f) == buffer.size() && fflush(f) == 0 && fsync(fileno(f)) == 0;
+        if (f) {
+            ok = fclose(f) == 0 && ok;
+        }
+    });
+}
+
+void CheckpointWriter::finish() {
+    commit();
+}
+
+void CheckpointWriter::commit() {
+    if (!pending) {
+        return;
+    }
+    writer.join();
+    pending = false;
+
+    // The slot becomes the restart point only once every rank has it on disk
+    int good = ok ? 1 : 0;
+    MPI_Allreduce(MPI_IN_PLACE, &good, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (rank != 0) {
+        return;
+    }
+    if (!good) {
+        cerr << "Checkpoint of superstep " << superstep << " failed; keeping the previous one" << endl;
+        return;
+    }
+    string latest = prefix + ".latest";
+    string staged = latest + ".tmp";
+    FILE* f = fopen(staged.c_str(), "w");
+    if (!f || fprintf(f, "%d %d\n", slot, superstep) < 0 || fclose(f) != 0 || rename(staged.c_str(), latest.c_str()) != 0) {
+        cerr << "Failed to update " << latest << endl;
+    }
+}
+
+bool read_checkpoint(const string& prefix, int rank, int size, CheckpointState& state) {
+    int slot = committed_slot(prefix, rank);
+    int good = 0;
+    FILE* f = slot < 0 ? nullptr : fopen(slot_path(prefix, slot, rank).c_str(), "rb");
+    CheckpointHeader header;
+    if (f && fread(&header, sizeof(header), 1, f) == 1 && memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0 &&
+        header.rank == rank && header.size == size) {
+        int n = header.num_vertices, m = header.num_edges;
+        vector<int> out_offsets, out_targets;
+        good = read_array(f, state.graph.labels, n) && read_array(f, out_offsets, n + 1) && read_array(f, out_targets, m) &&
+               read_array(f, state.supports.cycle, m) && read_array(f, state.supports.flow, m) &&
+               read_array(f, state.removed, m);
+
+        // Labels are sorted and arcs are in (u, v) order, so rebuilding from the
+        // arcs reproduces the same dense ids and edge ids
+        if (good) {
+            vector<pair<VertexId, VertexId>> arcs;
+            arcs.reserve(m);
+            for (int u = 0; u < n; ++u) {
+                for (int i = out_offsets[u]; i < out_offsets[u + 1]; ++i) {
+                    arcs.push_back({state.graph.labels[u], state.graph.labels[out_targets[i]]});
+                }
+            }
+            build_digraph(arcs, state.graph);
+            good = state.graph.num_edges() == m;
+        }
+        state.info.stage = header.stage;
+        state.info.superstep = header.superstep;
+        state.info.k_c = header.k_c;
+        state.info.k_f = header.k_f;
+    }
+    if (f) {
+        fclose(f);
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &good, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    return good != 0;
+}
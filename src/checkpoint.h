@@ -0,0 +1,68 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <thread>
+#include <vector>
+#include "digraph.h"
+#include "graph.h"
+
+// Point of the run a checkpoint was taken at
+enum CheckpointStage {
+    CHECKPOINT_FRAGMENT = 1,  // between levels of the local peel
+    CHECKPOINT_SUPERSTEP = 2  // between supersteps of the distributed peel
+};
+
+struct CheckpointInfo {
+    int stage;
+    int superstep; // supersteps, or levels of the local peel, done
+    int k_c, k_f;  // peel thresholds (query), last levels done (local peel)
+};
+
+// State read back from a checkpoint
+struct CheckpointState {
+    CheckpointInfo info;
+    DiGraph graph;
+    EdgeSupports supports;
+    std::vector<char> removed;
+};
+
+// Per-rank binary checkpoints "<prefix>.<slot>.<rank>": a header, the rank's
+// graph as CSR over original ids (labels, out_offsets, out_targets), then the
+// supports and removed flags, both indexed by edge id. Two slots
+// alternate so that a failure while writing never loses the last complete
+// checkpoint; rank 0 records the newest slot every rank finished in
+// "<prefix>.latest".
+class CheckpointWriter {
+public:
+    CheckpointWriter(const std::string& prefix, int rank, int size);
+    ~CheckpointWriter();
+
+    // Copy the state into a buffer and write it from a background thread, so
+    // the peel continues while the file is written. Collective: the previous
+    // checkpoint is committed first.
+    void write(const CheckpointInfo& info, const DiGraph& G, const EdgeSupports& supports,
+               const std::vector<char>& removed);
+
+    // Wait for the write in flight and commit it. Collective.
+    void finish();
+
+private:
+    void commit();
+
+    std::string prefix;
+    int rank, size;
+    int slot;              // slot of the last write
+    int superstep = 0;     // of the write in flight
+    bool pending = false;
+    bool ok = true;        // set by the writer thread
+    std::vector<char> buffer;
+    std::thread writer;
+};
+
+// Load this rank's part of the last committed checkpoint. Collective; returns
+// false on every rank unless all ranks found a complete checkpoint written by
+// the same number of ranks.
+bool read_checkpoint(const std::string& prefix, int rank, int size, CheckpointState& state);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,80 @@
+#include "digraph.h"
+#include <algorithm>
+
+void build_digraph(std::vector<std::pair<VertexId, VertexId>>& arcs, DiGraph& G) {
+    // Dense relabeling: vertices are numbered in increasing original id
+    G.labels.clear();
+    G.labels.reserve(arcs.size() * 2);
+    for (const auto& arc : arcs) {
+        G.labels.push_back(arc.first);
+        G.labels.push_back(arc.second);
+    }
+    std::sort(G.labels.begin(), G.labels.end());
+    G.labels.erase(std::unique(G.labels.begin(), G.labels.end()), G.labels.end());
+    G.labels.shrink_to_fit();
+    G.num_vertices = static_cast<int>(G.labels.size());
+
+    // Arcs in dense ids take half the space, so the wide list is released first
+    std::vector<std::pair<int, int>> dense;
+    dense.reserve(arcs.size());
+    for (const auto& arc : arcs) {
+        if (arc.first != arc.second) {
+            dense.push_back({dense_vertex(G, arc.first), dense_vertex(G, arc.second)});
+        }
+    }
+    std::vector<std::pair<VertexId, VertexId>>().swap(arcs);
+    std::sort(dense.begin(), dense.end());
+    dense.erase(std::unique(dense.begin(), dense.end()), dense.end());
+
+    int n = G.num_vertices;
+    int m = static_cast<int>(dense.size());
+
+    // CSR: arcs are sorted by (u, v), so edge ids follow directly
+    G.out_offsets.assign(n + 1, 0);
+    G.out_targets.resize(m);
+    G.edge_sources.resize(m);
+    G.in_offsets.assign(n + 1, 0);
+    for (int e = 0; e < m; ++e) {
+        G.out_offsets[dense[e].first + 1]++;
+        G.in_offsets[dense[e].second + 1]++;
+        G.edge_sources[e] = dense[e].first;
+        G.out_targets[e] = dense[e].second;
+    }
+    for (int x = 0; x < n; ++x) {
+        G.out_offsets[x + 1] += G.out_offsets[x];
+        G.in_offsets[x + 1] += G.in_offsets[x];
+    }
+    std::vector<std::pair<int, int>>().swap(dense);
+
+    // CSC: scanning edges in id order keeps every in-list sorted by tail
+    G.in_sources.resize(m);
+    G.in_edge_ids.resize(m);
+    std::vector<int> cursor(G.in_offsets.begin(), G.in_offsets.end() - 1);
+    for (int e = 0; e < m; ++e) {
+        int pos = cursor[G.out_targets[e]]++;
+        G.in_sources[pos] = G.edge_sources[e];
+        G.in_edge_ids[pos] = e;
+    }
+}
+
+int dense_vertex(const DiGraph& G, VertexId label) {
+    auto it = std::lower_bound(G.labels.begin(), G.labels.end(), label);
+    if (it == G.labels.end() || *it != label) {
+        return -1;
+    }
+    return static_cast<int>(it - G.labels.begin());
+}
+
+int find_edge(const DiGraph& G, int u, int v) {
+    // Binary search whichever of out(u) / in(v) is shorter
+    if (G.out_degree(u) <= G.in_degree(v)) {
+        auto first = G.out_targets.begin() + G.out_offsets[u];
+        auto last = G.out_targets.begin() + G.out_offsets[u + 1];
+        auto it = std::lower_bound(first, last, v);
+        return (it != last && *it == v) ? static_cast<int>(it - G.out_targets.begin()) : -1;
+    }
+    auto first = G.in_sources.begin() + G.in_offsets[v];
+    auto last = G.in_sources.begin() + G.in_offsets[v + 1];
+    auto it = std::lower_bound(first, last, u);
+    return (it != last && *it == u) ? G.in_edge_ids[it - G.in_sources.begin()] : -1;
+}
@@ -0,0 +1,153 @@
+#ifndef DIGRAPH_H
+#define DIGRAPH_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// External (input) vertex id. Internally vertices are dense 32-bit ids.
+typedef int64_t VertexId;
+
+// Immutable directed graph in CSR (out-adjacency) + CSC (in-adjacency) form.
+// Vertices are relabeled to dense ids [0, num_vertices); both adjacency arrays
+// are sorted, and the position of an arc in out_targets is its edge id.
+struct DiGraph {
+    int num_vertices = 0;
+    std::vector<VertexId> labels;  // dense id -> original vertex id
+    std::vector<int> out_offsets;  // size num_vertices + 1
+    std::vector<int> out_targets;  // edge id -> head (dense)
+    std::vector<int> edge_sources; // edge id -> tail (dense)
+    std::vector<int> in_offsets;   // size num_vertices + 1
+    std::vector<int> in_sources;   // sorted tails of the in-arcs of each vertex
+    std::vector<int> in_edge_ids;  // CSC position -> edge id
+
+    int num_edges() const { return static_cast<int>(out_targets.size()); }
+    int out_degree(int u) const { return out_offsets[u + 1] - out_offsets[u]; }
+    int in_degree(int u) const { return in_offsets[u + 1] - in_offsets[u]; }
+    int source(int e) const { return edge_sources[e]; }
+    int target(int e) const { return out_targets[e]; }
+};
+
+// Build G from (u, v) arcs given in original vertex ids. Self-loops and
+// duplicate arcs are dropped. The arc list is consumed.
+void build_digraph(std::vector<std::pair<VertexId, VertexId>>& arcs, DiGraph& G);
+
+// Dense id of an original vertex id, or -1 if the vertex has no arcs.
+int dense_vertex(const DiGraph& G, VertexId label);
+
+// Edge id of the arc u -> v (dense ids), or -1 if it does not exist.
+int find_edge(const DiGraph& G, int u, int v);
+
+// Triangle visitors. For edge e = (u, v) they call f(e1, e2) once for every
+// pair of partner edges closing a triangle with e, skipping any triangle in
+// which an edge is marked in `removed` (pass nullptr to visit all).
+// Reciprocal arcs are two edge ids and a triangle's type follows from the arcs
+// present, so no bi-linked status is kept: removing an arc is one removed flag.
+//
+//   cycle: u -> v -> w -> u                      partners (v, w), (w, u)
+//   flow:  u -> w -> v                           partners (u, w), (w, v)
+//          w -> u, w -> v                        partners (w, u), (w, v)
+//          u -> w, v -> w                        partners (u, w), (v, w)
+template <typename F>
+void for_each_cycle_triangle(const DiGraph& G, int e, const std::vector<char>* removed, F f) {
+    int u = G.source(e), v = G.target(e);
+    int i = G.out_offsets[v], i_end = G.out_offsets[v + 1];
+    int j = G.in_offsets[u], j_end = G.in_offsets[u + 1];
+    while (i < i_end && j < j_end) {
+        int a = G.out_targets[i], b = G.in_sources[j];
+        if (a < b) {
+            ++i;
+        } else if (b < a) {
+            ++j;
+        } else {
+            int e1 = i, e2 = G.in_edge_ids[j];
+            if (!removed || (!(*removed)[e1] && !(*removed)[e2])) {
+                f(e1, e2);
+            }
+            ++i;
+            ++j;
+        }
+    }
+}
+
+namespace digraph_detail {
+
+// Merge two sorted neighbor ranges, mapping matched positions to edge ids.
+template <typename IdA, typename IdB, typename F>
+void merge_ranges(const int* a, int a_len, IdA id_a, const int* b, int b_len, IdB id_b,
+                  const std::vector<char>* removed, F& f) {
+    int i = 0, j = 0;
+    while (i < a_len && j < b_len) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            int e1 = id_a(i), e2 = id_b(j);
+            if (!removed || (!(*removed)[e1] && !(*removed)[e2])) {
+                f(e1, e2);
+            }
+            ++i;
+            ++j;
+        }
+    }
+}
+
+} // namespace digraph_detail
+
+template <typename F>
+void for_each_flow_triangle(const DiGraph& G, int e, const std::vector<char>* removed, F f) {
+    int u = G.source(e), v = G.target(e);
+    const int* out_u = G.out_targets.data() + G.out_offsets[u];
+    const int* out_v = G.out_targets.data() + G.out_offsets[v];
+    const int* in_u = G.in_sources.data() + G.in_offsets[u];
+    const int* in_v = G.in_sources.data() + G.in_offsets[v];
+    int out_u_base = G.out_offsets[u], out_v_base = G.out_offsets[v];
+    const int* in_u_ids = G.in_edge_ids.data() + G.in_offsets[u];
+    const int* in_v_ids = G.in_edge_ids.data() + G.in_offsets[v];
+    auto out_u_id = [out_u_base](int i) { return out_u_base + i; };
+    auto out_v_id = [out_v_base](int i) { return out_v_base + i; };
+    auto in_u_id = [in_u_ids](int i) { return in_u_ids[i]; };
+    auto in_v_id = [in_v_ids](int i) { return in_v_ids[i]; };
+
+    digraph_detail::merge_ranges(out_u, G.out_degree(u), out_u_id, in_v, G.in_degree(v), in_v_id, removed, f);
+    digraph_detail::merge_ranges(in_u, G.in_degree(u), in_u_id, in_v, G.in_degree(v), in_v_id, removed, f);
+    digraph_detail::merge_ranges(out_u, G.out_degree(u), out_u_id, out_v, G.out_degree(v), out_v_id, removed, f);
+}
+
+// Function objects wrapping the visitors, for code templated on the triangle type
+struct CycleTriangles {
+    template <typename F>
+    void operator()(const DiGraph& G, int e, const std::vector<char>* removed, F f) const {
+        for_each_cycle_triangle(G, e, removed, f);
+    }
+};
+
+struct FlowTriangles {
+    template <typename F>
+    void operator()(const DiGraph& G, int e, const std::vector<char>* removed, F f) const {
+        for_each_flow_triangle(G, e, removed, f);
+    }
+};
+
+// Largest h such that at least h triangles of e (skipping `removed`) have both
+// partners at value >= h, capped at `cap`. `count` is caller-owned scratch.
+// Iterating this from any upper bound of the trussness converges to it.
+template <typename Visit>
+int triangle_h_index(const DiGraph& G, int e, const std::vector<char>* removed, const std::vector<int>& value, int cap, Visit visit, std::vector<int>& count) {
+    count.assign(cap + 1, 0);
+    visit(G, e, removed, [&](int e1, int e2) {
+        int v = value[e1] < value[e2] ? value[e1] : value[e2];
+        count[v < cap ? v : cap]++;
+    });
+    int at_least = 0;
+    for (int h = cap; h > 0; --h) {
+        at_least += count[h];
+        if (at_least >= h) {
+            return h;
+        }
+    }
+    return 0;
+}
+
+#endif // DIGRAPH_H
@@ -0,0 +1,159 @@
+#include "dist_graph.h"
+#include "mpi_utils.h"
+#include <algorithm>
+
+template <typename T>
+static void sort_unique(vector<T>& values) {
+    sort(values.begin(), values.end());
+    values.erase(unique(values.begin(), values.end()), values.end());
+}
+
+void distribute_graph(vector<pair<VertexId, VertexId>>& arcs, int rank, int size, DistGraph& D) {
+    typedef pair<VertexId, VertexId> Arc;
+    D.rank = rank;
+    D.size = size;
+
+    // (1) Send every arc to the owners of both of its endpoints
+    vector<vector<Arc>> outgoing(size);
+    for (const auto& arc : arcs) {
+        if (arc.first == arc.second) {
+            continue;
+        }
+        int owner_u = vertex_owner(arc.first, size);
+        int owner_v = vertex_owner(arc.second, size);
+        outgoing[owner_u].push_back(arc);
+        if (owner_v != owner_u) {
+            outgoing[owner_v].push_back(arc);
+        }
+    }
+    vector<Arc>().swap(arcs);
+    vector<Arc> incident = exchange_arcs(outgoing, MPI_COMM_WORLD);
+
+    // (2) Ghosts are the remote heads of owned arcs; ask their owners for them
+    vector<vector<VertexId>> requests(size);
+    for (const auto& arc : incident) {
+        if (vertex_owner(arc.first, size) == rank && vertex_owner(arc.second, size) != rank) {
+            requests[vertex_owner(arc.second, size)].push_back(arc.second);
+        }
+    }
+    vector<VertexId> ghosts;
+    for (auto& list : requests) {
+        sort_unique(list);
+        ghosts.insert(ghosts.end(), list.begin(), list.end());
+    }
+    sort(ghosts.begin(), ghosts.end());
+    vector<int> request_counts;
+    vector<VertexId> requested = alltoallv_exchange(requests, MPI_COMM_WORLD, &request_counts);
+    vector<vector<VertexId>>().swap(requests);
+
+    // (3) Answer with the full neighbor lists of the requested owned vertices
+    vector<Arc> incident_copy(incident);
+    DiGraph owned_view;
+    build_digraph(incident_copy, owned_view);
+
+    vector<pair<VertexId, int>> subscriptions; // (vertex, subscribing rank)
+    size_t next = 0;
+    for (int r = 0; r < size; ++r) {
+        for (int k = 0; k < request_counts[r]; ++k, ++next) {
+            VertexId x = requested[next];
+            subscriptions.push_back({x, r});
+            int d = dense_vertex(owned_view, x);
+            if (d < 0) {
+                continue;
+            }
+            for (int i = owned_view.out_offsets[d]; i < owned_view.out_offsets[d + 1]; ++i) {
+                outgoing[r].push_back({x, owned_view.labels[owned_view.out_targets[i]]});
+            }
+            for (int i = owned_view.in_offsets[d]; i < owned_view.in_offsets[d + 1]; ++i) {
+                outgoing[r].push_back({owned_view.labels[owned_view.in_sources[i]], x});
+            }
+        }
+    }
+    owned_view = DiGraph();
+    vector<Arc> ghost_arcs = exchange_arcs(outgoing, MPI_COMM_WORLD);
+
+    // Every holder of a ghost also learns its other subscribers, so updates to an
+    // arc can be routed to all ranks holding a copy of it. Notices are bucketed
+    // by subscriber rank: per shared vertex, its id, the number of other
+    // subscribers and their ranks. A sole subscriber gets nothing.
+    sort(subscriptions.begin(), subscriptions.end());
+    vector<vector<VertexId>> notices(size);
+    for (size_t i = 0; i < subscriptions.size(); ) {
+        size_t j = i;
+        while (j < subscriptions.size() && subscriptions[j].first == subscriptions[i].first) {
+            ++j;
+        }
+        for (size_t a = i; a < j && j - i > 1; ++a) {
+            vector<VertexId>& bucket = notices[subscriptions[a].second];
+            bucket.push_back(subscriptions[i].first);
+            bucket.push_back(static_cast<VertexId>(j - i - 1));
+            for (size_t b = i; b < j; ++b) {
+                if (b != a) {
+                    bucket.push_back(subscriptions[b].second);
+                }
+            }
+        }
+        i = j;
+    }
+    vector<VertexId> received_notices = alltoallv_exchange(notices, MPI_COMM_WORLD);
+    vector<vector<VertexId>>().swap(notices);
+    for (size_t k = 0; k < received_notices.size(); ) {
+        VertexId x = received_notices[k];
+        size_t count = static_cast<size_t>(received_notices[k + 1]);
+        for (size_t t = 0; t < count; ++t) {
+            subscriptions.push_back({x, static_cast<int>(received_notices[k + 2 + t])});
+        }
+        k += 2 + count;
+    }
+
+    // (4) Local store over owned and ghost adjacency
+    incident.insert(incident.end(), ghost_arcs.begin(), ghost_arcs.end());
+    vector<Arc>().swap(ghost_arcs);
+    build_digraph(incident, D.local);
+
+    const DiGraph& G = D.local;
+    D.vertex_role.assign(G.num_vertices, 0);
+    for (int x = 0; x < G.num_vertices; ++x) {
+        VertexId label = G.labels[x];
+        if (vertex_owner(label, size) == rank) {
+            D.vertex_role[x] = DistGraph::OWNED_VERTEX;
+        } else if (binary_search(ghosts.begin(), ghosts.end(), label)) {
+            D.vertex_role[x] = DistGraph::GHOST_VERTEX;
+        }
+    }
+
+    D.owned_edges.clear();
+    for (int e = 0; e < G.num_edges(); ++e) {
+        if (D.owns_edge(e)) {
+            D.owned_edges.push_back(e);
+        }
+    }
+
+    // Subscribers of each owned or ghost vertex, as CSR over local vertex ids
+    D.subscriber_offsets.assign(G.num_vertices + 1, 0);
+    for (auto& s : subscriptions) {
+        s.first = dense_vertex(G, s.first);
+    }
+    subscriptions.erase(remove_if(subscriptions.begin(), subscriptions.end(), [](const pair<VertexId, int>& s) {
+        return s.first < 0;
+    }), subscriptions.end());
+    sort(subscriptions.begin(), subscriptions.end());
+    D.subscribers.resize(subscriptions.size());
+    for (size_t i = 0; i < subscriptions.size(); ++i) {
+        D.subscriber_offsets[subscriptions[i].first + 1]++;
+        D.subscribers[i] = subscriptions[i].second;
+    }
+    for (int x = 0; x < G.num_vertices; ++x) {
+        D.subscriber_offsets[x + 1] += D.subscriber_offsets[x];
+    }
+}
+
+void DistGraph::arc_holders(int e, vector<int>& ranks) const {
+    ranks.clear();
+    for (int x : {local.source(e), local.target(e)}) {
+        ranks.push_back(vertex_owner(local.labels[x], size));
+        ranks.insert(ranks.end(), subscribers.begin() + subscriber_offsets[x], subscribers.begin() + subscriber_offsets[x + 1]);
+    }
+    sort_unique(ranks);
+    ranks.erase(remove(ranks.begin(), ranks.end(), rank), ranks.end());
+}
@@ -0,0 +1,45 @@
+#ifndef DIST_GRAPH_H
+#define DIST_GRAPH_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "digraph.h"
+
+// Owner rank of a vertex (original id). Vertices are hashed so that hubs and
+// id ranges spread evenly across ranks.
+inline int vertex_owner(VertexId vertex, int size) {
+    uint64_t h = static_cast<uint64_t>(vertex) * 0x9e3779b97f4a7c15ull;
+    return static_cast<int>((h ^ (h >> 32)) % static_cast<uint64_t>(size));
+}
+
+// Owner-based distributed layout. Each rank owns the arcs whose tail it owns
+// and stores the full adjacency of its owned vertices plus that of every
+// ghost vertex (a remote head of an owned arc), so the triangles of every
+// owned edge can be closed locally. Memory is O(|E|/p + ghost adjacency).
+struct DistGraph {
+    int rank = 0;
+    int size = 1;
+    DiGraph local;                       // owned and ghost adjacency, dense local ids
+    std::vector<char> vertex_role;       // per local vertex: OWNED_VERTEX, GHOST_VERTEX or 0
+    std::vector<int> owned_edges;        // local edge ids owned by this rank
+    std::vector<int> subscriber_offsets; // per local vertex, CSR into subscribers
+    std::vector<int> subscribers;        // ranks holding an owned or ghost vertex as a ghost
+
+    bool owns_edge(int e) const { return vertex_role[local.source(e)] == OWNED_VERTEX; }
+    int edge_owner(int e) const { return vertex_owner(local.labels[local.source(e)], size); }
+
+    // Other ranks holding a copy of local arc e: the owners and subscribers of both endpoints
+    void arc_holders(int e, std::vector<int>& ranks) const;
+
+    static const char OWNED_VERTEX = 1;
+    static const char GHOST_VERTEX = 2;
+};
+
+// Build the layout from this rank's share of the input arcs (any split).
+// Arcs go to the owners of both endpoints, then one ghost exchange pulls in
+// the neighbor lists of remote heads. Both exchanges ship arcs delta-encoded.
+// The arc list is consumed.
+void distribute_graph(std::vector<std::pair<VertexId, VertexId>>& arcs, int rank, int size, DistGraph& D);
+
+#endif // DIST_GRAPH_H
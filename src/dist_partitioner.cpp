@@ -0,0 +1,328 @@
+#include "dist_partitioner.h"
+#include "mpi_utils.h"
+#include "thread_pool.h"
+#include "scratch.h"
+#include <mpi.h>
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#include <queue>
+#include <unordered_map>
+
+// Owned edges per work-stealing chunk for affinity scoring
+static const int AFFINITY_GRAIN = 256;
+
+// Histogram cells per collective call, keeping MPI counts within int
+static const size_t HISTOGRAM_CHUNK = 1 << 24;
+
+// Sorted union of every rank's distinct keys
+static vector<long long> global_keys(vector<long long> keys) {
+    sort(keys.begin(), keys.end());
+    keys.erase(unique(keys.begin(), keys.end()), keys.end());
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int count = static_cast<int>(keys.size());
+    vector<int> counts(size), displs(size, 0);
+    MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for (int r = 1; r < size; ++r) {
+        displs[r] = displs[r - 1] + counts[r - 1];
+    }
+    vector<long long> all(displs[size - 1] + counts[size - 1]);
+    MPI_Allgatherv(keys.data(), count, MPI_LONG_LONG, all.data(), counts.data(), displs.data(), MPI_LONG_LONG, MPI_COMM_WORLD);
+    sort(all.begin(), all.end());
+    all.erase(unique(all.begin(), all.end()), all.end());
+    return all;
+}
+
+vector<int> stratified_targets(const DistGraph& D, const vector<int>& k_c, const vector<int>& k_f) {
+    const vector<int>& owned = D.owned_edges;
+    int n = static_cast<int>(owned.size());
+
+    // Only the (k_c, k_f) pairs that occur on some rank get a cell; their keys
+    // sort in row-major order
+    vector<long long> key(n);
+    for (int i = 0; i < n; ++i) {
+        key[i] = static_cast<long long>(k_c[owned[i]]) << 32 | static_cast<unsigned>(k_f[owned[i]]);
+    }
+    vector<long long> occupied = global_keys(key);
+    size_t cells = occupied.size();
+    vector<size_t> cell(n);
+    for (int i = 0; i < n; ++i) {
+        cell[i] = lower_bound(occupied.begin(), occupied.end(), key[i]) - occupied.begin();
+    }
+
+    // Joint (k_c, k_f) weight histogram: below[c] on lower ranks, start[c] in
+    // the cells before c in row-major order (its prefix sum)
+    vector<long long> local_hist(cells, 0), hist(cells), below(cells, 0), start(cells);
+    for (int i = 0; i < n; ++i) {
+        local_hist[cell[i]] += k_f[owned[i]] + 1;
+    }
+    for (size_t first = 0; first < cells; first += HISTOGRAM_CHUNK) {
+        int count = static_cast<int>(min(HISTOGRAM_CHUNK, cells - first));
+        MPI_Exscan(local_hist.data() + first, below.data() + first, count, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(local_hist.data() + first, hist.data() + first, count, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    }
+    if (D.rank == 0) {
+        fill(below.begin(), below.end(), 0);
+    }
+    long long total = 0;
+    for (size_t c = 0; c < cells; ++c) {
+        start[c] = total;
+        total += hist[c];
+    }
+
+    // Position of each edge in the global (k_c, k_f, rank) order picks its range
+    vector<int> targets(n, 0);
+    vector<long long>& offset = local_hist;
+    fill(offset.begin(), offset.end(), 0);
+    for (int i = 0; i < n; ++i) {
+        long long position = start[cell[i]] + below[cell[i]] + offset[cell[i]];
+        targets[i] = min(D.size - 1, static_cast<int>(static_cast<double>(position) / total * D.size));
+        offset[cell[i]] += k_f[owned[i]] + 1;
+    }
+    return targets;
+}
+
+// Indexed binary min-heap over partition loads: the lightest load is read in
+// O(1) and an increased load is restored in O(log p).
+class LoadHeap {
+public:
+    explicit LoadHeap(int p) : load(p, 0), heap(p), pos(p) {
+        for (int i = 0; i < p; ++i) {
+            heap[i] = i;
+            pos[i] = i;
+        }
+    }
+
+    long long operator[](int i) const { return load[i]; }
+    int lightest() const { return heap[0]; }
+
+    void add(int i, long long delta) {
+        load[i] += delta;
+        int k = pos[i], n = static_cast<int>(heap.size());
+        while (true) {
+            int c = 2 * k + 1;
+            if (c >= n) {
+                break;
+            }
+            if (c + 1 < n && load[heap[c + 1]] < load[heap[c]]) {
+                ++c;
+            }
+            if (load[heap[c]] >= load[heap[k]]) {
+                break;
+            }
+            swap(heap[k], heap[c]);
+            pos[heap[k]] = k;
+            pos[heap[c]] = c;
+            k = c;
+        }
+    }
+
+private:
+    vector<long long> load;
+    vector<int> heap, pos;
+};
+
+// Affinity of an owned edge (by index into D.owned_edges) to a remote rank
+struct Affinity {
+    int edge, rank, triangles;
+};
+
+template <typename Visit>
+static vector<int> affinity_targets(const DistGraph& D, double epsilon, const vector<int>& support, Visit visit) {
+    const DiGraph& G = D.local;
+    const vector<int>& owned = D.owned_edges;
+    int n = static_cast<int>(owned.size());
+    int p = D.size;
+
+    // Triangles around each owned edge whose partners are both owned by the same
+    // rank; an edge wants to move if some other rank has more than this one
+    vector<int> proposal(n, D.rank);
+    ThreadPool& pool = thread_pool();
+    WorkerScratch<int> affinities(pool.size()), hits(pool.size());
+    WorkerScratch<Affinity> found(pool.size());
+    pool.parallel_for(0, n, AFFINITY_GRAIN, [&](int begin, int end, int worker) {
+        // Per-worker counters, zero again after every edge
+        vector<int>& affinity = affinities[worker];
+        vector<int>& hit = hits[worker];
+        affinity.resize(p, 0);
+        for (int i = begin; i < end; ++i) {
+            visit(G, owned[i], nullptr, [&](int e1, int e2) {
+                int r = D.edge_owner(e1);
+                if (r == D.edge_owner(e2)) {
+                    if (affinity[r]++ == 0) {
+                        hit.push_back(r);
+                    }
+                }
+            });
+            int best = D.rank;
+            for (int r : hit) {
+                if (affinity[r] > affinity[best]) {
+                    best = r;
+                }
+            }
+            proposal[i] = best;
+            for (int r : hit) {
+                if (best != D.rank && r != D.rank) {
+                    found[worker].push_back({i, r, affinity[r]});
+                }
+                affinity[r] = 0;
+            }
+            hit.clear();
+        }
+    });
+
+    // Movers are candidates of every other rank they have triangles with. Each
+    // candidate heap is keyed by the triangles the edge would close there; a
+    // score only grows and every change pushes a new entry, so outdated
+    // entries are recognized and dropped when popped. Score nodes come from
+    // one arena that is freed with the placement.
+    typedef unordered_map<int, int, hash<int>, equal_to<int>, ArenaAllocator<pair<const int, int>>> ScoreMap;
+    MonotonicArena arena;
+    vector<long long> stay(p, 0), demand(p, 0);
+    vector<priority_queue<pair<int, int>>> candidates(p);
+    vector<ScoreMap> score;
+    score.reserve(p);
+    for (int r = 0; r < p; ++r) {
+        score.emplace_back(0, hash<int>(), equal_to<int>(), ArenaAllocator<pair<const int, int>>(arena));
+    }
+    for (int i = 0; i < n; ++i) {
+        if (proposal[i] == D.rank) {
+            stay[D.rank] += support[owned[i]] + 1;
+        }
+    }
+    for (int worker = 0; worker < found.size(); ++worker) {
+        for (const Affinity& a : found[worker]) {
+            demand[a.rank] += support[owned[a.edge]] + 1;
+            score[a.rank][a.edge] = a.triangles;
+            candidates[a.rank].push({a.triangles, a.edge});
+        }
+    }
+    vector<long long> local_demand(demand);
+    long long total = 0;
+    for (int e : owned) {
+        total += support[e] + 1;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, stay.data(), p, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, demand.data(), p, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    // Room left in each rank after the edges that stay, shared among the ranks
+    // in proportion to the load they would like to move there
+    double capacity = epsilon * total / p;
+    vector<long long> quota(p, 0);
+    for (int r = 0; r < p; ++r) {
+        if (r != D.rank && demand[r] > 0) {
+            quota[r] = static_cast<long long>(max(0.0, capacity - stay[r]) * local_demand[r] / demand[r]);
+        }
+    }
+
+    vector<int> owned_index(G.num_edges(), -1);
+    for (int i = 0; i < n; ++i) {
+        owned_index[owned[i]] = i;
+    }
+    vector<int> targets(n, D.rank);
+    vector<char> placed(n, 0);
+    auto in_rank = [&](int e, int r) {
+        int i = owned_index[e];
+        return i >= 0 ? placed[i] && targets[i] == r : D.edge_owner(e) == r;
+    };
+
+    // The lightest rank takes its best candidate that still fits. Placing an
+    // edge only rescores the movers that share a triangle with it.
+    const long long RETIRED = LLONG_MAX / 2;
+    LoadHeap load(p);
+    int active = 0;
+    for (int r = 0; r < p; ++r) {
+        if (candidates[r].empty() || quota[r] == 0) {
+            load.add(r, RETIRED);
+        } else {
+            ++active;
+        }
+    }
+    while (active > 0) {
+        int r = load.lightest();
+        int i = -1;
+        while (!candidates[r].empty() && i < 0) {
+            pair<int, int> top = candidates[r].top();
+            candidates[r].pop();
+            if (!placed[top.second] && score[r][top.second] == top.first) {
+                i = top.second;
+            }
+        }
+        if (i < 0) {
+            load.add(r, RETIRED);
+            --active;
+            continue;
+        }
+        long long w = support[owned[i]] + 1;
+        if (load[r] + w > quota[r]) {
+            continue;
+        }
+        targets[i] = r;
+        placed[i] = 1;
+        load.add(r, w);
+        auto bump = [&](int x, int other) {
+            int j = owned_index[x];
+            if (j < 0 || placed[j] || proposal[j] == D.rank || !in_rank(other, r)) {
+                return;
+            }
+            int& s = score[r][j];
+            candidates[r].push({++s, j});
+        };
+        visit(G, owned[i], nullptr, [&](int e1, int e2) {
+            bump(e1, e2);
+            bump(e2, e1);
+        });
+    }
+    return targets;
+}
+
+vector<int> type_aware_targets(const DistGraph& D, const EdgeSupports& supports, double epsilon, const string& triangle_type) {
+    if (triangle_type == "c") {
+        return affinity_targets(D, epsilon, supports.cycle, CycleTriangles());
+    }
+    return affinity_targets(D, epsilon, supports.flow, FlowTriangles());
+}
+
+void migrate_edges(const DistGraph& D, const EdgeSupports& supports, const vector<int>& targets, Fragment& F) {
+    const DiGraph& G = D.local;
+    vector<vector<EdgeRecord>> outgoing(D.size);
+    for (size_t i = 0; i < D.owned_edges.size(); ++i) {
+        int e = D.owned_edges[i];
+        outgoing[targets[i]].push_back({G.labels[G.source(e)], G.labels[G.target(e)], supports.cycle[e], supports.flow[e]});
+    }
+    vector<EdgeRecord> received = exchange_edge_records(outgoing, MPI_COMM_WORLD);
+
+    vector<pair<VertexId, VertexId>> arcs;
+    arcs.reserve(received.size());
+    for (const auto& edge : received) {
+        arcs.push_back({edge.u, edge.v});
+    }
+    F.graph = DiGraph();
+    build_digraph(arcs, F.graph);
+
+    const DiGraph& H = F.graph;
+    F.supports.assign(H.num_edges());
+    for (const auto& edge : received) {
+        int e = find_edge(H, dense_vertex(H, edge.u), dense_vertex(H, edge.v));
+        F.supports.cycle[e] = edge.cycle_support;
+        F.supports.flow[e] = edge.flow_support;
+    }
+}
+
+void return_fragment_values(const DistGraph& D, const Fragment& F, const vector<int>& fragment_c, const vector<int>& fragment_f, vector<int>& k_c, vector<int>& k_f) {
+    const DiGraph& H = F.graph;
+    vector<vector<EdgeRecord>> outgoing(D.size);
+    for (int e = 0; e < H.num_edges(); ++e) {
+        VertexId u = H.labels[H.source(e)];
+        outgoing[vertex_owner(u, D.size)].push_back({u, H.labels[H.target(e)], fragment_c[e], fragment_f[e]});
+    }
+    for (const auto& edge : exchange_edge_records(outgoing, MPI_COMM_WORLD)) {
+        int e = local_edge_id(D, edge.u, edge.v);
+        if (e >= 0) {
+            k_c[e] = min(k_c[e], edge.cycle_support);
+            k_f[e] = min(k_f[e], edge.flow_support);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef DIST_PARTITIONER_H
+#define DIST_PARTITIONER_H
+
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "dist_graph.h"
+
+// One partition after migration, held by the rank of the same number as a
+// standalone graph. supports are indexed by fragment edge id and keep the
+// values computed on the owner layout.
+struct Fragment {
+    DiGraph graph;
+    EdgeSupports supports;
+
+    // A partition is moved into place, never copied
+    Fragment() = default;
+    Fragment(Fragment&&) = default;
+    Fragment& operator=(Fragment&&) = default;
+    Fragment(const Fragment&) = delete;
+    Fragment& operator=(const Fragment&) = delete;
+};
+
+// Distributed partitioning phase. Every rank scores only its owned edges, the
+// ranks agree on boundaries and loads with collectives, and each call returns
+// the target rank of every owned edge, indexed like D.owned_edges. Trussness
+// estimates k_c and k_f are indexed by local edge id (supports are a valid
+// upper bound).
+
+enum PartitionerType {
+    TYPE_AWARE_BALANCED,
+    STRATIFIED_BALANCED
+};
+
+// Stratified: prefix sums over a global histogram of the (k_c, k_f) pairs that
+// occur place every owned edge in one (k_c, k_f)-sorted order, and rank r
+// takes the r-th of p contiguous ranges of equal total weight (k_f + 1 per edge).
+std::vector<int> stratified_targets(const DistGraph& D, const std::vector<int>& k_c, const std::vector<int>& k_f);
+
+// Type-aware: an edge moves if another rank owns more triangles of the given
+// type around it (both partners owned there) than its own. Each rank's free
+// room up to epsilon times the average load is shared among the ranks by
+// demand, and every rank fills its shares greedily: the lightest target takes
+// the candidate that closes the most triangles there, from a lazily updated
+// heap. Edges that do not fit stay.
+std::vector<int> type_aware_targets(const DistGraph& D, const EdgeSupports& supports, double epsilon, const std::string& triangle_type);
+
+// Send every owned edge to its target rank (as delta-encoded records) and
+// build the local fragment
+void migrate_edges(const DistGraph& D, const EdgeSupports& supports, const std::vector<int>& targets, Fragment& F);
+
+// Send per-edge values of the fragment (indexed by fragment edge id) back to
+// the owners of the edges, which lower k_c and k_f (local edge ids) to them
+void return_fragment_values(const DistGraph& D, const Fragment& F, const std::vector<int>& fragment_c, const std::vector<int>& fragment_f, std::vector<int>& k_c, std::vector<int>& k_f);
+
+#endif // DIST_PARTITIONER_H
@@ -0,0 +1,246 @@
+#include "edge_io.h"
+#include <mpi.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+const char BINARY_EDGE_MAGIC[8] = {'D', 'D', 'T', 'E', 'D', 'G', 'E', '1'};
+const char WIDE_EDGE_MAGIC[8] = {'D', 'D', 'T', 'E', 'D', 'G', 'E', '2'};
+
+// Largest single MPI-IO transfer, kept below INT_MAX bytes
+static const uint64_t IO_CHUNK_BYTES = 1 << 30;
+
+// Read-only memory mapping of a whole file
+struct MappedFile {
+    const char* data = nullptr;
+    size_t length = 0;
+
+    bool open(const string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+            madvise(p, length, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(p);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    ~MappedFile() {
+        if (data) {
+            munmap(const_cast<char*>(data), length);
+        }
+    }
+};
+
+static inline bool parse_id(const char*& p, const char* end, VertexId& value) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) {
+        ++p;
+    }
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return false;
+    }
+    VertexId x = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        x = x * 10 + (*p - '0');
+        ++p;
+    }
+    value = negative ? -x : x;
+    return true;
+}
+
+// Parse every line starting in [p, range_end); the last one may run on to file_end
+template <typename F>
+static void parse_edge_lines(const char* p, const char* range_end, const char* file_end, F emit) {
+    while (p < range_end) {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', file_end - p));
+        const char* line_end = nl ? nl : file_end;
+        VertexId u, v;
+        const char* q = p;
+        if (parse_id(q, line_end, u) && parse_id(q, line_end, v)) {
+            emit(u, v);
+        }
+        p = line_end + 1;
+    }
+}
+
+bool is_binary_edge_file(const string& filename) {
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    char magic[8];
+    bool binary = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+                  (memcmp(magic, BINARY_EDGE_MAGIC, sizeof(magic)) == 0 || memcmp(magic, WIDE_EDGE_MAGIC, sizeof(magic)) == 0);
+    fclose(f);
+    return binary;
+}
+
+void read_text_edges(const string& filename, int rank, int size, vector<pair<VertexId, VertexId>>& arcs) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        cerr << "Failed to open file: " << filename << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    const char* file_end = file.data + file.length;
+    size_t begin = file.length / size * rank + min<size_t>(rank, file.length % size);
+    size_t end = begin + file.length / size + (static_cast<size_t>(rank) < file.length % size ? 1 : 0);
+
+    // A line belongs to the rank whose range contains its first byte
+    const char* p = file.data + begin;
+    if (begin > 0 && file.data[begin - 1] != '\n') {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', file_end - p));
+        p = nl ? nl + 1 : file_end;
+    }
+
+    arcs.reserve(arcs.size() + (end - begin) / 8);
+    parse_edge_lines(p, file.data + end, file_end, [&arcs](VertexId u, VertexId v) {
+        arcs.push_back({u, v});
+    });
+}
+
+void read_binary_edges(const string& filename, int rank, int size, vector<pair<VertexId, VertexId>>& arcs) {
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        cerr << "Failed to open file: " << filename << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    BinaryEdgeHeader header;
+    MPI_File_read_at_all(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    bool wide = memcmp(header.magic, WIDE_EDGE_MAGIC, sizeof(header.magic)) == 0;
+    if (!wide && memcmp(header.magic, BINARY_EDGE_MAGIC, sizeof(header.magic)) != 0) {
+        cerr << "Not a binary edge file: " << filename << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    uint64_t m = header.num_edges;
+    uint64_t first = m / size * rank + min<uint64_t>(rank, m % size);
+    uint64_t count = m / size + (static_cast<uint64_t>(rank) < m % size ? 1 : 0);
+    uint64_t max_count = m / size + (m % size ? 1 : 0);
+
+    // pair<VertexId, VertexId> is two packed int64, matching the wide layout;
+    // narrow pairs are read into the front of the same space and widened in place
+    size_t id_bytes = wide ? sizeof(int64_t) : sizeof(int32_t);
+    size_t old_size = arcs.size();
+    arcs.resize(old_size + count);
+    char* buffer = reinterpret_cast<char*>(arcs.data() + old_size);
+    uint64_t bytes = count * 2 * id_bytes;
+    uint64_t max_bytes = max_count * 2 * id_bytes;
+    MPI_Offset offset = sizeof(BinaryEdgeHeader) + first * 2 * id_bytes;
+
+    // Every rank takes part in the same number of collective reads
+    for (uint64_t done = 0; done < max_bytes; done += IO_CHUNK_BYTES) {
+        uint64_t n = done < bytes ? min(IO_CHUNK_BYTES, bytes - done) : 0;
+        MPI_File_read_at_all(fh, offset + done, buffer + min(done, bytes), static_cast<int>(n), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    if (!wide) {
+        // Back to front, so no narrow pair is overwritten before it is read
+        const int32_t* narrow = reinterpret_cast<const int32_t*>(buffer);
+        for (uint64_t i = count; i-- > 0; ) {
+            int32_t u = narrow[2 * i], v = narrow[2 * i + 1];
+            arcs[old_size + i] = {u, v};
+        }
+    }
+
+    MPI_File_close(&fh);
+}
+
+// Stream the edge list through a fixed buffer so it never sits in memory.
+// Returns false if a narrow write meets an id that needs 64 bits.
+static bool write_binary_edges(const MappedFile& in, FILE* out, bool wide, BinaryEdgeHeader& header) {
+    memcpy(header.magic, wide ? WIDE_EDGE_MAGIC : BINARY_EDGE_MAGIC, sizeof(header.magic));
+    header.num_edges = 0;
+    fwrite(&header, sizeof(header), 1, out);
+
+    vector<int64_t> wide_buffer;
+    vector<int32_t> narrow_buffer;
+    const size_t capacity = 1 << 20;
+    wide_buffer.reserve(wide ? capacity : 0);
+    narrow_buffer.reserve(wide ? 0 : capacity);
+    bool fits = true;
+    auto flush = [&]() {
+        if (wide) {
+            fwrite(wide_buffer.data(), sizeof(int64_t), wide_buffer.size(), out);
+            header.num_edges += wide_buffer.size() / 2;
+            wide_buffer.clear();
+        } else {
+            fwrite(narrow_buffer.data(), sizeof(int32_t), narrow_buffer.size(), out);
+            header.num_edges += narrow_buffer.size() / 2;
+            narrow_buffer.clear();
+        }
+    };
+    const char* file_end = in.data + in.length;
+    parse_edge_lines(in.data, file_end, file_end, [&](VertexId u, VertexId v) {
+        if (wide) {
+            wide_buffer.push_back(u);
+            wide_buffer.push_back(v);
+        } else if (u != static_cast<int32_t>(u) || v != static_cast<int32_t>(v)) {
+            fits = false;
+        } else {
+            narrow_buffer.push_back(static_cast<int32_t>(u));
+            narrow_buffer.push_back(static_cast<int32_t>(v));
+        }
+        if (wide_buffer.size() >= capacity || narrow_buffer.size() >= capacity) {
+            flush();
+        }
+    });
+    flush();
+    return fits;
+}
+
+uint64_t convert_text_to_binary(const string& text_file, const string& binary_file) {
+    MappedFile in;
+    if (!in.open(text_file)) {
+        cerr << "Failed to open file: " << text_file << endl;
+        return 0;
+    }
+    FILE* out = fopen(binary_file.c_str(), "wb");
+    if (!out) {
+        cerr << "Failed to open file: " << binary_file << endl;
+        return 0;
+    }
+
+    // The narrow layout halves the file; rewrite wide only if an id needs it
+    BinaryEdgeHeader header;
+    if (!write_binary_edges(in, out, false, header)) {
+        out = freopen(binary_file.c_str(), "wb", out);
+        if (!out) {
+            cerr << "Failed to open file: " << binary_file << endl;
+            return 0;
+        }
+        write_binary_edges(in, out, true, header);
+    }
+
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+    fclose(out);
+    return header.num_edges;
+}
@@ -0,0 +1,37 @@
+#ifndef EDGE_IO_H
+#define EDGE_IO_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "digraph.h"
+
+// Binary edge list: this header followed by num_edges (u, v) pairs, of int32
+// (BINARY_EDGE_MAGIC) or, when some vertex id does not fit, of int64
+// (WIDE_EDGE_MAGIC).
+struct BinaryEdgeHeader {
+    char magic[8];
+    uint64_t num_edges;
+};
+
+extern const char BINARY_EDGE_MAGIC[8];
+extern const char WIDE_EDGE_MAGIC[8];
+
+bool is_binary_edge_file(const std::string& filename);
+
+// Text input, memory-mapped. Rank r parses only bytes [r*N/p, (r+1)*N/p),
+// widened to line boundaries, so each line is parsed by exactly one rank.
+// Lines that do not start with a vertex id (comments, blank lines) are skipped.
+void read_text_edges(const std::string& filename, int rank, int size, std::vector<std::pair<VertexId, VertexId>>& arcs);
+
+// Binary input through MPI-IO: rank r reads edges [r*m/p, (r+1)*m/p) with one
+// collective read and no parsing.
+void read_binary_edges(const std::string& filename, int rank, int size, std::vector<std::pair<VertexId, VertexId>>& arcs);
+
+// Convert a text edge list to the binary format (single process, streaming),
+// using the int32 layout unless an id needs 64 bits. Returns the number of
+// edges written.
+uint64_t convert_text_to_binary(const std::string& text_file, const std::string& binary_file);
+
+#endif // EDGE_IO_H
@@ -0,0 +1,85 @@
+#include "generator.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+using namespace std;
+
+// Sampled arcs per work-stealing chunk
+static const int GENERATOR_GRAIN = 4096;
+
+// Sampled arcs per parallel_for call, so that a rank's share of a large graph
+// never overflows the int range of the loop
+static const uint64_t GENERATOR_BATCH = 1ull << 30;
+
+// SplitMix64: a small counter-based generator, one stream per arc
+struct ArcRandom {
+    uint64_t state;
+
+    explicit ArcRandom(uint64_t key) : state(key) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+// Bijection on [0, 2^scale)
+static inline uint64_t scramble(uint64_t x, int scale, uint64_t seed) {
+    uint64_t mask = scale >= 64 ? ~0ull : (1ull << scale) - 1;
+    x = (x * 0x2545f4914f6cdd1dull + seed) & mask;
+    x ^= x >> (scale / 2 + 1);
+    x = (x * 0x9e3779b97f4a7c15ull) & mask;
+    return x ^ (x >> (scale / 3 + 1));
+}
+
+static pair<uint64_t, uint64_t> sample_rmat(const GeneratorConfig& config, ArcRandom& random) {
+    uint64_t u = 0, v = 0;
+    double ab = config.a + config.b, abc = ab + config.c;
+    for (int level = 0; level < config.scale; ++level) {
+        double r = random.uniform();
+        u = (u << 1) | (r >= ab);
+        v = (v << 1) | ((r >= config.a && r < ab) || r >= abc);
+    }
+    return {u, v};
+}
+
+void generate_arcs(const GeneratorConfig& config, int rank, int size, vector<pair<VertexId, VertexId>>& arcs) {
+    uint64_t n = 1ull << config.scale;
+    uint64_t total = n * config.edge_factor;
+    uint64_t begin = total * rank / size, end = total * (rank + 1) / size;
+
+    bool rmat = config.model != "er";
+    ThreadPool& pool = thread_pool();
+    vector<vector<pair<VertexId, VertexId>>> local(pool.size());
+    arcs.clear();
+    for (uint64_t batch = begin; batch < end; batch += GENERATOR_BATCH) {
+        int count = static_cast<int>(min(GENERATOR_BATCH, end - batch));
+        pool.parallel_for(0, count, GENERATOR_GRAIN, [&](int first, int last, int worker) {
+            vector<pair<VertexId, VertexId>>& out = local[worker];
+            for (int i = first; i < last; ++i) {
+                ArcRandom random(config.seed * 0xd1342543de82ef95ull ^ (batch + i));
+                pair<uint64_t, uint64_t> arc;
+                if (rmat) {
+                    arc = sample_rmat(config, random);
+                } else {
+                    arc = {random.next() & (n - 1), random.next() & (n - 1)};
+                }
+                VertexId u = static_cast<VertexId>(scramble(arc.first, config.scale, config.seed));
+                VertexId v = static_cast<VertexId>(scramble(arc.second, config.scale, config.seed));
+                out.push_back({u, v});
+                if (random.uniform() < config.reciprocity) {
+                    out.push_back({v, u});
+                }
+            }
+        });
+
+        for (auto& part : local) {
+            arcs.insert(arcs.end(), part.begin(), part.end());
+            vector<pair<VertexId, VertexId>>().swap(part);
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "digraph.h"
+
+// Synthetic directed graph on 2^scale vertices with edge_factor * 2^scale
+// sampled arcs (before self-loops and duplicates are dropped).
+//   rmat: recursive quadrant choice with probabilities a, b, c and
+//         d = 1 - a - b - c; a larger a gives a more skewed degree distribution
+//   er:   endpoints uniform (Erdos-Renyi G(n, m))
+// Each sampled arc is followed by its reverse with probability reciprocity.
+// Vertex ids are scrambled so that hubs are not clustered at small ids.
+struct GeneratorConfig {
+    std::string model = "rmat";
+    int scale = 16;
+    int edge_factor = 16;
+    double a = 0.57, b = 0.19, c = 0.19;
+    double reciprocity = 0.0;
+    uint64_t seed = 1;
+};
+
+// This rank's contiguous block of the sampled arcs. Every arc is drawn from a
+// random stream keyed by its global index, so the graph is the same for any
+// number of ranks.
+void generate_arcs(const GeneratorConfig& config, int rank, int size, std::vector<std::pair<VertexId, VertexId>>& arcs);
+
+#endif // GENERATOR_H
@@ -1,71 +1,133 @@
 #include "graph.h"
-#include <fstream>
+#include "triangles.h"
+#include "edge_io.h"
 #include <iostream>
+#include <algorithm>
+#include <mpi.h>
 
-void read_graph_data(const string& filename, int rank, int size, unordered_map<int, unordered_set<int>>& out_neighbors, unordered_map<int, unordered_set<int>>& in_neighbors, vector<Edge>& edges) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Failed to open file: " << filename << endl;
-        MPI_Abort(MPI_COMM_WORLD, 1);
+void read_graph_data(const string& filename, int rank, int size, DistGraph& D, EdgeSupports& supports) {
+    // Each rank parses (or reads) only its own slice of the input
+    vector<pair<VertexId, VertexId>> arcs;
+    if (is_binary_edge_file(filename)) {
+        read_binary_edges(filename, rank, size, arcs);
+    } else {
+        read_text_edges(filename, rank, size, arcs);
     }
 
-    int u, v;
-    int edge_count = 0;
-    while (file >> u >> v) {
-        if (edge_count % size == rank) {
-            out_neighbors[u].insert(v);
-            in_neighbors[v].insert(u);
-            edges.push_back({u, v, 0, 0});
+    // Move arcs to their owners and pull in ghost adjacency; supports are
+    // indexed by local edge id
+    distribute_graph(arcs, rank, size, D);
+    supports.assign(D.local.num_edges());
+}
+
+long long generate_graph_data(const GeneratorConfig& config, int rank, int size, DistGraph& D, EdgeSupports& supports) {
+    bool known = config.model == "rmat" || config.model == "er";
+    if (!known || config.scale < 1 || config.scale > 62 || config.edge_factor < 1) {
+        if (rank == 0 && !known) {
+            cerr << "Unknown graph model: " << config.model << " (use rmat or er)" << endl;
+        } else if (rank == 0) {
+            cerr << "Invalid generator size: --scale " << config.scale << " --edge-factor " << config.edge_factor << endl;
         }
-        edge_count++;
+        MPI_Abort(MPI_COMM_WORLD, 1);
     }
 
-    file.close();
-}
+    vector<pair<VertexId, VertexId>> arcs;
+    generate_arcs(config, rank, size, arcs);
+    distribute_graph(arcs, rank, size, D);
+    supports.assign(D.local.num_edges());
 
-void compute_supports(unordered_map<int, unordered_set<int>>& out_neighbors, unordered_map<int, unordered_set<int>>& in_neighbors, vector<Edge>& edges) {
-    // Compute initial cycle and flow supports for edges
-    for (auto& edge : edges) {
-        int u = edge.u, v = edge.v;
-        unordered_set<int> cycle_set, flow_set;
+    long long local_edges = static_cast<long long>(D.owned_edges.size()), global_edges = 0;
+    MPI_Allreduce(&local_edges, &global_edges, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    return global_edges;
+}
 
-        for (int w : out_neighbors[v]) {
-            if (out_neighbors[u].find(w) != out_neighbors[u].end()) {
-                cycle_set.insert(w);
-            }
-        }
+void compute_supports(const DiGraph& G, EdgeSupports& supports) {
+    // Compute initial cycle and flow supports for every edge id in one triangle pass
+    supports.assign(G.num_edges());
+    OrientedGraph O;
+    build_oriented_graph(G, nullptr, nullptr, O);
+    count_triangle_supports(O, supports.cycle, supports.flow);
+}
 
-        for (int w : in_neighbors[u]) {
-            if (in_neighbors[v].find(w) != in_neighbors[v].end()) {
-                flow_set.insert(w);
-            }
-        }
+// Supports of the owned edges over O, which is built here and kept for the caller
+static void count_owned_supports(const DistGraph& D, const vector<char>* removed, EdgeSupports& supports, OrientedGraph& O) {
+    vector<char> owned(D.local.num_vertices);
+    for (int x = 0; x < D.local.num_vertices; ++x) {
+        owned[x] = D.vertex_role[x] == DistGraph::OWNED_VERTEX;
+    }
+    for (int e : D.owned_edges) {
+        supports.cycle[e] = 0;
+        supports.flow[e] = 0;
+    }
+    build_oriented_graph(D.local, &owned, removed, O);
+    count_triangle_supports(O, supports.cycle, supports.flow);
+}
 
-        edge.cycle_support = cycle_set.size();
-        edge.flow_support = flow_set.size();
+void compute_supports(const DistGraph& D, EdgeSupports& supports, TriangleIndex* index, long long index_budget_bytes) {
+    // Owned edges see the full adjacency of both endpoints, so their counts are exact
+    // without any cross-rank reduction; ghost-only edges are left untouched
+    OrientedGraph O;
+    count_owned_supports(D, nullptr, supports, O);
+    if (index) {
+        // The counts just taken size the lists, so only the fill pass remains
+        index_triangles(O, D.local.num_edges(), D.owned_edges, supports.cycle, supports.flow, index_budget_bytes, *index);
     }
 }
 
-void update_supports(vector<Edge>& edges, vector<Edge>& received_edges) {
-    // Update cycle and flow supports based on received messages
-    for (auto& received_edge : received_edges) {
-        for (auto& edge : edges) {
-            if (edge.u == received_edge.u && edge.v == received_edge.v) {
-                edge.cycle_support = received_edge.cycle_support;
-                edge.flow_support = received_edge.flow_support;
-            }
+void compute_owned_supports(const DistGraph& D, const vector<char>* removed, EdgeSupports& supports) {
+    OrientedGraph O;
+    count_owned_supports(D, removed, supports, O);
+}
+
+int local_edge_id(const DistGraph& D, VertexId u, VertexId v) {
+    // Original ids -> local edge id through the dense relabeling and CSR index
+    int du = dense_vertex(D.local, u);
+    int dv = dense_vertex(D.local, v);
+    return (du < 0 || dv < 0) ? -1 : find_edge(D.local, du, dv);
+}
+
+void update_supports(const DistGraph& D, EdgeSupports& supports, const vector<EdgeDelta>& received) {
+    // Apply the support changes received for owned edges through the edge-id index
+    for (const auto& delta : received) {
+        int e = local_edge_id(D, delta.u, delta.v);
+        if (e >= 0) {
+            supports.cycle[e] += delta.cycle_delta;
+            supports.flow[e] += delta.flow_delta;
         }
     }
 }
 
-void peel_edges(vector<Edge>& edges, int k_c, int k_f) {
+void peel_edges(const EdgeSupports& supports, vector<char>& removed, int k_c, int k_f) {
     // Peel edges that do not meet the support criteria
-    edges.erase(remove_if(edges.begin(), edges.end(), [k_c, k_f](const Edge& edge) {
-        return edge.cycle_support < k_c || edge.flow_support < k_f;
-    }), edges.end());
+    for (int e = 0; e < supports.size(); ++e) {
+        if (supports.cycle[e] < k_c || supports.flow[e] < k_f) {
+            removed[e] = 1;
+        }
+    }
 }
 
-void prepare_messages(vector<Edge>& edges, vector<Edge>& messages) {
-    // Prepare messages to be sent in the next superstep
-    messages = edges;
-}
\ No newline at end of file
+void prepare_messages(const DistGraph& D, vector<EdgeDelta>& deltas, vector<vector<EdgeDelta>>& messages) {
+    // Only changed edges are sent: merge the deltas per edge, then bucket them by owner
+    sort(deltas.begin(), deltas.end(), [](const EdgeDelta& a, const EdgeDelta& b) {
+        return a.u != b.u ? a.u < b.u : a.v < b.v;
+    });
+    // Lists are emptied rather than reallocated, so their capacity is reused
+    messages.resize(D.size);
+    for (auto& list : messages) {
+        list.clear();
+    }
+    for (size_t i = 0; i < deltas.size(); ) {
+        EdgeDelta merged = deltas[i];
+        size_t j = i + 1;
+        while (j < deltas.size() && deltas[j].u == merged.u && deltas[j].v == merged.v) {
+            merged.cycle_delta += deltas[j].cycle_delta;
+            merged.flow_delta += deltas[j].flow_delta;
+            ++j;
+        }
+        if (merged.cycle_delta != 0 || merged.flow_delta != 0) {
+            messages[vertex_owner(merged.u, D.size)].push_back(merged);
+        }
+        i = j;
+    }
+    deltas.clear();
+}
@@ -1,22 +1,50 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 #include <string>
+#include "digraph.h"
+#include "dist_graph.h"
+#include "generator.h"
 
 using namespace std;
 
-struct Edge {
-    int u, v;
-    int cycle_support, flow_support;
+struct TriangleIndex;
+
+// Cycle and flow supports as a structure of arrays indexed by edge id; the
+// endpoints of edge e come from the graph it belongs to (source(e), target(e)),
+// so an edge costs 8 bytes here instead of carrying its ids along.
+struct EdgeSupports {
+    vector<int> cycle;
+    vector<int> flow;
+
+    int size() const { return static_cast<int>(cycle.size()); }
+    void assign(int num_edges) {
+        cycle.assign(num_edges, 0);
+        flow.assign(num_edges, 0);
+    }
+};
+
+// Superstep message about edge (u, v), addressed by original vertex ids: a
+// support change for the owner, or a notice that the edge was peeled.
+struct EdgeDelta {
+    VertexId u, v;
+    int cycle_delta, flow_delta;
 };
 
-void read_graph_data(const string& filename, int rank, int size, unordered_map<int, unordered_set<int>>& out_neighbors, unordered_map<int, unordered_set<int>>& in_neighbors, vector<Edge>& edges);
-void compute_supports(unordered_map<int, unordered_set<int>>& out_neighbors, unordered_map<int, unordered_set<int>>& in_neighbors, vector<Edge>& edges);
-void update_supports(vector<Edge>& edges, vector<Edge>& received_edges);
-void peel_edges(vector<Edge>& edges, int k_c, int k_f);
-void prepare_messages(vector<Edge>& edges, vector<Edge>& messages);
+void read_graph_data(const string& filename, int rank, int size, DistGraph& D, EdgeSupports& supports);
+// Same layout for a synthetic graph generated in place; returns its global edge count
+long long generate_graph_data(const GeneratorConfig& config, int rank, int size, DistGraph& D, EdgeSupports& supports);
+void compute_supports(const DiGraph& G, EdgeSupports& supports);
+// With an index, the triangles of the owned edges are also indexed within
+// index_budget_bytes, sized by the counting pass itself
+void compute_supports(const DistGraph& D, EdgeSupports& supports, TriangleIndex* index = nullptr, long long index_budget_bytes = 0);
+// Supports of the owned edges with the edges marked in `removed` (may be nullptr) left out
+void compute_owned_supports(const DistGraph& D, const vector<char>* removed, EdgeSupports& supports);
+void update_supports(const DistGraph& D, EdgeSupports& supports, const vector<EdgeDelta>& received);
+// Mark the edges missing either threshold
+void peel_edges(const EdgeSupports& supports, vector<char>& removed, int k_c, int k_f);
+void prepare_messages(const DistGraph& D, vector<EdgeDelta>& deltas, vector<vector<EdgeDelta>>& messages);
+int local_edge_id(const DistGraph& D, VertexId u, VertexId v);
 
 #endif // GRAPH_H
\ No newline at end of file
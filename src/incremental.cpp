@@ -0,0 +1,221 @@
+#include "incremental.h"
+#include "digraph.h"
+#include "intersect.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+bool read_edge_updates(const string& filename, vector<EdgeUpdate>& updates) {
+    FILE* f = fopen(filename.c_str(), "r");
+    if (!f) {
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char* p = line;
+        while (*p == ' ' || *p == '\t') {
+            ++p;
+        }
+        bool insert = true;
+        if (*p == '+' || *p == '-') {
+            insert = *p == '+';
+            ++p;
+        }
+        char* q;
+        long long u = strtoll(p, &q, 10);
+        if (q == p) {
+            continue;
+        }
+        p = q;
+        long long v = strtoll(p, &q, 10);
+        if (q == p) {
+            continue;
+        }
+        updates.push_back({static_cast<VertexId>(u), static_cast<VertexId>(v), insert});
+    }
+    fclose(f);
+    return true;
+}
+
+// Lower value[] to the local h-index fixed point, starting from the edges in
+// `work`. Values only ever decrease, so from any pointwise upper bound of the
+// trussness the iteration settles exactly on it. Partners are re-queued only
+// when they lie in `scope` (nullptr: everywhere) and can still drop.
+template <typename Visit>
+static void repair_values(const DiGraph& G, const vector<char>* removed, const vector<char>* scope, vector<int> work, Visit visit, vector<int>& value, vector<char>& touched) {
+    vector<char> queued(G.num_edges(), 0);
+    vector<int> stack, count;
+    for (int e : work) {
+        if (!queued[e]) {
+            queued[e] = 1;
+            stack.push_back(e);
+        }
+    }
+
+    while (!stack.empty()) {
+        int e = stack.back();
+        stack.pop_back();
+        queued[e] = 0;
+        if (removed && (*removed)[e]) {
+            continue;
+        }
+        touched[e] = 1;
+        int h = triangle_h_index(G, e, removed, value, value[e], visit, count);
+        if (h == value[e]) {
+            continue;
+        }
+        value[e] = h;
+        auto requeue = [&](int p) {
+            if (value[p] > h && !queued[p] && (!scope || (*scope)[p])) {
+                queued[p] = 1;
+                stack.push_back(p);
+            }
+        };
+        visit(G, e, removed, [&](int e1, int e2) {
+            requeue(e1);
+            requeue(e2);
+        });
+    }
+}
+
+// Raise the values that insertions can affect, then settle them. An edge can
+// only gain trussness if it is triangle-connected to a new edge through edges
+// that gain as well, and a gaining edge has support above its old value, so
+// the search expands only through such edges. Their supports, from
+// support(e), serve as upper bounds; every other value is already exact.
+template <typename Visit, typename Support>
+static void raise_values(const DiGraph& G, const vector<char>& is_new, Visit visit, Support support, vector<int>& value, vector<char>& touched) {
+    int m = G.num_edges();
+    vector<char> candidate(m, 0), checked(m, 0);
+    vector<int> region;
+    auto check = [&](int e) {
+        if (checked[e]) {
+            return;
+        }
+        checked[e] = 1;
+        int s = support(e);
+        if (is_new[e] || s > value[e]) {
+            candidate[e] = 1;
+            value[e] = s;
+            region.push_back(e);
+        }
+    };
+
+    for (int e = 0; e < m; ++e) {
+        if (is_new[e]) {
+            check(e);
+        }
+    }
+    for (size_t i = 0; i < region.size(); ++i) {
+        visit(G, region[i], nullptr, [&](int e1, int e2) {
+            check(e1);
+            check(e2);
+        });
+    }
+
+    repair_values(G, nullptr, &candidate, region, visit, value, touched);
+}
+
+static int lookup_edge(const DiGraph& G, VertexId u, VertexId v) {
+    int du = dense_vertex(G, u), dv = dense_vertex(G, v);
+    return (du < 0 || dv < 0 || du == dv) ? -1 : find_edge(G, du, dv);
+}
+
+UpdateStats apply_edge_updates(vector<ResultRecord>& results, const vector<EdgeUpdate>& updates) {
+    UpdateStats stats;
+
+    // The previous decomposition is the graph
+    vector<pair<VertexId, VertexId>> arcs;
+    arcs.reserve(results.size());
+    for (const auto& r : results) {
+        arcs.push_back({r.u, r.v});
+    }
+    DiGraph G;
+    build_digraph(arcs, G);
+    int m = G.num_edges();
+    vector<int> cycle(m, 0), flow(m, 0);
+    for (const auto& r : results) {
+        int e = lookup_edge(G, r.u, r.v);
+        if (e >= 0) {
+            cycle[e] = r.k_c;
+            flow[e] = r.k_f;
+        }
+    }
+    vector<int> old_cycle = cycle, old_flow = flow;
+
+    // Deletions: the partners of every triangle lost are the only seeds
+    vector<char> removed(m, 0), touched(m, 0);
+    vector<int> cycle_work, flow_work;
+    for (const auto& update : updates) {
+        int e = update.insert ? -1 : lookup_edge(G, update.u, update.v);
+        if (e < 0 || removed[e]) {
+            continue;
+        }
+        for_each_cycle_triangle(G, e, &removed, [&cycle_work](int e1, int e2) {
+            cycle_work.push_back(e1);
+            cycle_work.push_back(e2);
+        });
+        for_each_flow_triangle(G, e, &removed, [&flow_work](int e1, int e2) {
+            flow_work.push_back(e1);
+            flow_work.push_back(e2);
+        });
+        removed[e] = 1;
+        stats.deleted++;
+    }
+    repair_values(G, &removed, nullptr, cycle_work, CycleTriangles(), cycle, touched);
+    repair_values(G, &removed, nullptr, flow_work, FlowTriangles(), flow, touched);
+
+    // Rebuild with the insertions and carry the values over
+    arcs.clear();
+    for (int e = 0; e < m; ++e) {
+        if (!removed[e]) {
+            arcs.push_back({G.labels[G.source(e)], G.labels[G.target(e)]});
+        }
+    }
+    for (const auto& update : updates) {
+        if (update.insert) {
+            arcs.push_back({update.u, update.v});
+        }
+    }
+    DiGraph H;
+    build_digraph(arcs, H);
+    int n_edges = H.num_edges();
+    vector<int> h_cycle(n_edges, 0), h_flow(n_edges, 0), h_old_cycle(n_edges, 0), h_old_flow(n_edges, 0);
+    vector<char> is_new(n_edges, 1), h_touched(n_edges, 0);
+    for (int e = 0; e < m; ++e) {
+        if (removed[e]) {
+            continue;
+        }
+        int f = lookup_edge(H, G.labels[G.source(e)], G.labels[G.target(e)]);
+        is_new[f] = 0;
+        h_cycle[f] = cycle[e];
+        h_flow[f] = flow[e];
+        h_old_cycle[f] = old_cycle[e];
+        h_old_flow[f] = old_flow[e];
+        h_touched[f] = touched[e];
+    }
+    G = DiGraph();
+
+    // Insertions. Supports are counted on demand with the intersection
+    // kernels, both types at once, so the flow pass reuses the cycle counts.
+    vector<int> cycle_support(n_edges, -1), flow_support(n_edges, -1);
+    auto count_support = [&](int e) {
+        if (cycle_support[e] < 0) {
+            count_edge_triangles(H, e, cycle_support[e], flow_support[e]);
+        }
+    };
+    raise_values(H, is_new, CycleTriangles(), [&](int e) { count_support(e); return cycle_support[e]; }, h_cycle, h_touched);
+    raise_values(H, is_new, FlowTriangles(), [&](int e) { count_support(e); return flow_support[e]; }, h_flow, h_touched);
+
+    results.clear();
+    results.reserve(n_edges);
+    for (int e = 0; e < n_edges; ++e) {
+        results.push_back({H.labels[H.source(e)], H.labels[H.target(e)], h_cycle[e], h_flow[e]});
+        stats.inserted += is_new[e];
+        stats.repaired += h_touched[e] || is_new[e];
+        stats.changed += is_new[e] || h_cycle[e] != h_old_cycle[e] || h_flow[e] != h_old_flow[e];
+    }
+    return stats;
+}
@@ -0,0 +1,34 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <string>
+#include <vector>
+#include "digraph.h"
+#include "result_io.h"
+
+// One edge change in original vertex ids
+struct EdgeUpdate {
+    VertexId u, v;
+    bool insert;
+};
+
+// Update batch, one change per line: "+ u v" inserts, "- u v" deletes, and a
+// bare "u v" line is an insertion. Other lines are skipped.
+bool read_edge_updates(const std::string& filename, std::vector<EdgeUpdate>& updates);
+
+// Summary of one incremental run
+struct UpdateStats {
+    int inserted = 0, deleted = 0;  // updates that changed the edge set
+    int repaired = 0;               // edges whose trussness was re-evaluated
+    int changed = 0;                // edges whose (k_c, k_f) changed
+};
+
+// Apply a batch to a previous decomposition. The records are the graph: every
+// edge with its (k_c, k_f). Deletions are applied first and only lower values,
+// repaired by a local h-index iteration started at the old values; insertions
+// then raise values inside the triangle-connected region around the new edges,
+// iterated down from their supports. Only triangles of touched edges are
+// enumerated. On return `results` holds the updated graph and decomposition.
+UpdateStats apply_edge_updates(std::vector<ResultRecord>& results, const std::vector<EdgeUpdate>& updates);
+
+#endif // INCREMENTAL_H
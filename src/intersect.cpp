@@ -0,0 +1,204 @@
+#include "intersect.h"
+#include <algorithm>
+#include <climits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DDT_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Length ratio above which galloping beats a linear merge
+static const int GALLOP_RATIO = 32;
+
+// Endpoints whose lists are all at most this long use the combined kernel
+static const int COMBINED_KERNEL_MAX_DEGREE = 32;
+
+int intersect_count_scalar(const int* a, int a_len, const int* b, int b_len) {
+    int i = 0, j = 0, count = 0;
+    while (i < a_len && j < b_len) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+int intersect_count_gallop(const int* a, int a_len, const int* b, int b_len) {
+    if (a_len > b_len) {
+        std::swap(a, b);
+        std::swap(a_len, b_len);
+    }
+
+    // Exponential then binary search in b for each element of the shorter list
+    int count = 0, lo = 0;
+    for (int i = 0; i < a_len && lo < b_len; ++i) {
+        int x = a[i];
+        int step = 1, hi = lo;
+        while (hi < b_len && b[hi] < x) {
+            lo = hi + 1;
+            hi += step;
+            step <<= 1;
+        }
+        hi = std::min(hi + 1, b_len);
+        lo = static_cast<int>(std::lower_bound(b + lo, b + hi, x) - b);
+        if (lo < b_len && b[lo] == x) {
+            ++count;
+            ++lo;
+        }
+    }
+    return count;
+}
+
+#ifdef DDT_X86_SIMD
+
+__attribute__((target("avx2")))
+int intersect_count_avx2(const int* a, int a_len, const int* b, int b_len) {
+    // Compare 8-wide blocks against all rotations of each other, then advance
+    // the block with the smaller maximum
+    const __m256i rotate = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+    int i = 0, j = 0, count = 0;
+    while (i + 8 <= a_len && j + 8 <= b_len) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i match = _mm256_cmpeq_epi32(va, vb);
+        for (int r = 1; r < 8; ++r) {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            match = _mm256_or_si256(match, _mm256_cmpeq_epi32(va, vb));
+        }
+        count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(match)));
+
+        int a_max = a[i + 7], b_max = b[j + 7];
+        i += (a_max <= b_max) ? 8 : 0;
+        j += (b_max <= a_max) ? 8 : 0;
+    }
+    return count + intersect_count_scalar(a + i, a_len - i, b + j, b_len - j);
+}
+
+__attribute__((target("avx512f")))
+int intersect_count_avx512(const int* a, int a_len, const int* b, int b_len) {
+    int i = 0, j = 0, count = 0;
+    while (i + 16 <= a_len && j + 16 <= b_len) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + j);
+        __mmask16 match = _mm512_cmpeq_epi32_mask(va, vb);
+        for (int r = 1; r < 16; ++r) {
+            // Full-mask form: the unmasked intrinsic merges into an undefined
+            // vector, which GCC reports as maybe-uninitialized
+            vb = _mm512_mask_alignr_epi32(vb, 0xFFFF, vb, vb, 1);
+            match |= _mm512_cmpeq_epi32_mask(va, vb);
+        }
+        count += __builtin_popcount(match);
+
+        int a_max = a[i + 15], b_max = b[j + 15];
+        i += (a_max <= b_max) ? 16 : 0;
+        j += (b_max <= a_max) ? 16 : 0;
+    }
+    return count + intersect_count_avx2(a + i, a_len - i, b + j, b_len - j);
+}
+
+static IntersectKernel select_kernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return intersect_count_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return intersect_count_avx2;
+    }
+    return intersect_count_scalar;
+}
+
+#else
+
+int intersect_count_avx2(const int* a, int a_len, const int* b, int b_len) {
+    return intersect_count_scalar(a, a_len, b, b_len);
+}
+
+int intersect_count_avx512(const int* a, int a_len, const int* b, int b_len) {
+    return intersect_count_scalar(a, a_len, b, b_len);
+}
+
+static IntersectKernel select_kernel() {
+    return intersect_count_scalar;
+}
+
+#endif
+
+static IntersectKernel dispatched_kernel() {
+    static const IntersectKernel kernel = select_kernel();
+    return kernel;
+}
+
+int intersect_count(const int* a, int a_len, const int* b, int b_len) {
+    if (a_len > b_len) {
+        std::swap(a, b);
+        std::swap(a_len, b_len);
+    }
+    if (a_len == 0) {
+        return 0;
+    }
+    if (b_len / a_len >= GALLOP_RATIO) {
+        return intersect_count_gallop(a, a_len, b, b_len);
+    }
+    return dispatched_kernel()(a, a_len, b, b_len);
+}
+
+NeighborCounts intersect_neighborhoods(const int* out_u, int out_u_len, const int* in_u, int in_u_len,
+                                       const int* out_v, int out_v_len, const int* in_v, int in_v_len) {
+    NeighborCounts counts = {0, 0, 0, 0};
+    int i = 0, j = 0, p = 0, q = 0;
+
+    // Walk the union of u's lists once, advancing both of v's cursors to each value
+    while ((i < out_u_len || j < in_u_len) && (p < out_v_len || q < in_v_len)) {
+        int w = std::min(i < out_u_len ? out_u[i] : INT_MAX, j < in_u_len ? in_u[j] : INT_MAX);
+        bool u_out = i < out_u_len && out_u[i] == w;
+        bool u_in = j < in_u_len && in_u[j] == w;
+
+        while (p < out_v_len && out_v[p] < w) {
+            ++p;
+        }
+        while (q < in_v_len && in_v[q] < w) {
+            ++q;
+        }
+        bool v_out = p < out_v_len && out_v[p] == w;
+        bool v_in = q < in_v_len && in_v[q] == w;
+
+        counts.out_out += u_out && v_out;
+        counts.out_in += u_out && v_in;
+        counts.in_out += u_in && v_out;
+        counts.in_in += u_in && v_in;
+
+        i += u_out;
+        j += u_in;
+    }
+    return counts;
+}
+
+void count_edge_triangles(const DiGraph& G, int e, int& cycle, int& flow) {
+    int u = G.source(e), v = G.target(e);
+    const int* out_u = G.out_targets.data() + G.out_offsets[u];
+    const int* out_v = G.out_targets.data() + G.out_offsets[v];
+    const int* in_u = G.in_sources.data() + G.in_offsets[u];
+    const int* in_v = G.in_sources.data() + G.in_offsets[v];
+    int out_u_len = G.out_degree(u), out_v_len = G.out_degree(v);
+    int in_u_len = G.in_degree(u), in_v_len = G.in_degree(v);
+
+    int max_len = std::max(std::max(out_u_len, out_v_len), std::max(in_u_len, in_v_len));
+    if (max_len <= COMBINED_KERNEL_MAX_DEGREE) {
+        NeighborCounts counts = intersect_neighborhoods(out_u, out_u_len, in_u, in_u_len, out_v, out_v_len, in_v, in_v_len);
+        cycle = counts.in_out;
+        flow = counts.out_in + counts.in_in + counts.out_out;
+        return;
+    }
+
+    // Cycle: v -> w -> u; flow: u -> w -> v, w -> {u, v}, {u, v} -> w
+    cycle = intersect_count(in_u, in_u_len, out_v, out_v_len);
+    flow = intersect_count(out_u, out_u_len, in_v, in_v_len)
+         + intersect_count(in_u, in_u_len, in_v, in_v_len)
+         + intersect_count(out_u, out_u_len, out_v, out_v_len);
+}
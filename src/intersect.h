@@ -0,0 +1,34 @@
+#ifndef INTERSECT_H
+#define INTERSECT_H
+
+#include "digraph.h"
+
+// Counting kernels for the intersection of two sorted, duplicate-free int arrays.
+typedef int (*IntersectKernel)(const int* a, int a_len, const int* b, int b_len);
+
+int intersect_count_scalar(const int* a, int a_len, const int* b, int b_len);
+int intersect_count_gallop(const int* a, int a_len, const int* b, int b_len);
+int intersect_count_avx2(const int* a, int a_len, const int* b, int b_len);
+int intersect_count_avx512(const int* a, int a_len, const int* b, int b_len);
+
+// Dispatching entry point: galloping search for skewed length pairs, otherwise
+// the widest merge kernel the CPU supports.
+int intersect_count(const int* a, int a_len, const int* b, int b_len);
+
+// The four in/out intersections of the neighborhoods of u and v
+struct NeighborCounts {
+    int out_out; // out(u) & out(v)
+    int out_in;  // out(u) & in(v)
+    int in_out;  // in(u) & out(v)
+    int in_in;   // in(u) & in(v)
+};
+
+// Combined kernel: all four counts in a single pass over the four lists
+NeighborCounts intersect_neighborhoods(const int* out_u, int out_u_len, const int* in_u, int in_u_len,
+                                       const int* out_v, int out_v_len, const int* in_v, int in_v_len);
+
+// Cycle and flow triangle counts of edge e, using the combined kernel for
+// low-degree endpoints and the dispatched pairwise kernels otherwise.
+void count_edge_triangles(const DiGraph& G, int e, int& cycle, int& flow);
+
+#endif // INTERSECT_H
@@ -1,51 +1,384 @@
 #include <mpi.h>
 #include "graph.h"
-#include "partitioner.h"
+#include "dist_partitioner.h"
+#include "truss_bounds.h"
+#include "query.h"
 #include "peeler.h"
 #include "mpi_utils.h"
+#include "thread_pool.h"
+#include "edge_io.h"
+#include "result_io.h"
+#include "incremental.h"
+#include "checkpoint.h"
+#include "profile.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+// Shared-file or per-rank shard output of (u, v, k_c, k_f) records
+static void write_output(std::vector<ResultRecord>& records, const std::string& output, OutputFormat format, bool shard_output, int rank) {
+    if (shard_output) {
+        write_result_shard(records, output, rank, format);
+    } else {
+        write_results(records, output, format);
+    }
+}
 
 int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
+    // Hybrid mode: worker threads compute and peel, only the main thread calls MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    // Load graph data
-    unordered_map<int, unordered_set<int>> out_neighbors;
-    unordered_map<int, unordered_set<int>> in_neighbors;
-    vector<Edge> local_edges;
-    read_graph_data("graph.e", rank, size, out_neighbors, in_neighbors, local_edges);
+    // Threads per rank (--threads 0 uses every hardware thread)
+    int num_threads = 1;
+    std::string input = "graph.e";
+    std::string output;
+    OutputFormat output_format = TEXT_OUTPUT;
+    bool shard_output = false;
+    std::string previous_results, update_file;
+    std::string convert_input, convert_output;
+    std::string merge_prefix, merge_output;
+    int merge_shards = 0;
+    int bound_rounds = 3;
+    int query_k_c = -1, query_k_f = -1;
+    std::string checkpoint_prefix;
+    int checkpoint_every = 10;
+    bool resume = false;
+    std::string profile_path;
+    bool profile_csv = false;
+    PartitionerType partitioner_type = STRATIFIED_BALANCED;
+    GeneratorConfig generator;
+    bool generate = false;
+    long long triangle_index_mb = 0;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0) {
+            num_threads = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--bound-rounds") == 0) {
+            // h-index rounds tightening the trussness bounds (0: supports only)
+            bound_rounds = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--input") == 0) {
+            input = argv[i + 1];
+        } else if (strcmp(argv[i], "--convert") == 0 && i + 2 < argc) {
+            // Text to binary edge list conversion, then exit
+            convert_input = argv[i + 1];
+            convert_output = argv[i + 2];
+        } else if (strcmp(argv[i], "--output") == 0) {
+            output = argv[i + 1];
+        } else if (strcmp(argv[i], "--output-format") == 0) {
+            output_format = strcmp(argv[i + 1], "binary") == 0 ? BINARY_OUTPUT : TEXT_OUTPUT;
+        } else if (strcmp(argv[i], "--shards") == 0) {
+            // Write one sorted file per rank instead of a shared file
+            shard_output = atoi(argv[i + 1]) != 0;
+        } else if (strcmp(argv[i], "--query") == 0 && i + 2 < argc) {
+            // Compute only the (k_c, k_f)-truss
+            query_k_c = atoi(argv[i + 1]);
+            query_k_f = atoi(argv[i + 2]);
+        } else if (strcmp(argv[i], "--checkpoint") == 0) {
+            // Checkpoint the peel state to <prefix>.<slot>.<rank>
+            checkpoint_prefix = argv[i + 1];
+        } else if (strcmp(argv[i], "--checkpoint-every") == 0) {
+            // Supersteps of a query, or levels of the local peel, between checkpoints
+            checkpoint_every = std::max(1, atoi(argv[i + 1]));
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            // Restart from the last complete checkpoint under <prefix> and keep checkpointing there
+            checkpoint_prefix = argv[i + 1];
+            resume = true;
+        } else if (strcmp(argv[i], "--generate") == 0) {
+            // Synthetic input instead of a file: "rmat" or "er"
+            generator.model = argv[i + 1];
+            generate = true;
+        } else if (strcmp(argv[i], "--scale") == 0) {
+            generator.scale = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--edge-factor") == 0) {
+            generator.edge_factor = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--rmat") == 0) {
+            // Quadrant probabilities "a,b,c"
+            sscanf(argv[i + 1], "%lf,%lf,%lf", &generator.a, &generator.b, &generator.c);
+        } else if (strcmp(argv[i], "--reciprocity") == 0) {
+            generator.reciprocity = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            generator.seed = strtoull(argv[i + 1], nullptr, 10);
+        } else if (strcmp(argv[i], "--partitioner") == 0) {
+            partitioner_type = strcmp(argv[i + 1], "type-aware") == 0 ? TYPE_AWARE_BALANCED : STRATIFIED_BALANCED;
+        } else if (strcmp(argv[i], "--triangle-index") == 0) {
+            // Memory budget (MB per rank) for per-edge triangle lists used by the local peel
+            triangle_index_mb = atoll(argv[i + 1]);
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            // Per-phase time, traffic, peeled edges and memory, summarized over ranks
+            profile_path = argv[i + 1];
+        } else if (strcmp(argv[i], "--profile-format") == 0) {
+            profile_csv = strcmp(argv[i + 1], "csv") == 0;
+        } else if (strcmp(argv[i], "--update") == 0 && i + 2 < argc) {
+            // Incremental mode: previous results plus a batch of edge changes
+            previous_results = argv[i + 1];
+            update_file = argv[i + 2];
+        } else if (strcmp(argv[i], "--merge") == 0 && i + 3 < argc) {
+            // Merge sorted shards <prefix>.0 .. <prefix>.<n-1> into one file, then exit
+            merge_prefix = argv[i + 1];
+            merge_shards = atoi(argv[i + 2]);
+            merge_output = argv[i + 3];
+        }
+    }
 
-    // Select partitioner type
-    PartitionerType partitioner_type = STRATIFIED_BALANCED; // or STRATIFIED_BALANCED
-    std::vector<std::unordered_set<Edge>> partitions;
+    // One-shot file tools run once every option they depend on is known
+    if (!convert_input.empty() || !merge_prefix.empty()) {
+        if (rank == 0 && !convert_input.empty()) {
+            uint64_t m = convert_text_to_binary(convert_input, convert_output);
+            std::cout << "Wrote " << m << " edges to " << convert_output << std::endl;
+        }
+        if (rank == 0 && !merge_prefix.empty() &&
+            !merge_result_shards(merge_prefix, merge_shards, merge_output, output_format)) {
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        MPI_Finalize();
+        return 0;
+    }
+    init_thread_pool(num_threads);
 
-    // Perform partitioning
-    if (partitioner_type == TYPE_AWARE_BALANCED) {
-        partitions = type_aware_balanced_partitioner(G, size, 1.1, "c");
-    } else if (partitioner_type == STRATIFIED_BALANCED) {
-        partitions = stratified_balanced_partitioner(G, size);
+    if (!update_file.empty()) {
+        // Repair the previous decomposition instead of recomputing it
+        std::vector<ResultRecord> records;
+        if (rank == 0) {
+            std::vector<EdgeUpdate> updates;
+            if (!read_results(previous_results, records) || !read_edge_updates(update_file, updates)) {
+                std::cerr << "Failed to read " << previous_results << " or " << update_file << std::endl;
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            UpdateStats stats = apply_edge_updates(records, updates);
+            std::cout << "Inserted " << stats.inserted << ", deleted " << stats.deleted << ", repaired " << stats.repaired
+                      << ", changed " << stats.changed << " of " << records.size() << " edges" << std::endl;
+        }
+        write_results(records, output.empty() ? previous_results : output, output_format);
+        MPI_Finalize();
+        return 0;
     }
 
-    // Compute supports
-    compute_supports(partitions, rank);
+    // State of an interrupted run: a query restarts between supersteps, a full
+    // decomposition right after partitioning
+    CheckpointState restart;
+    int restart_stage = query_k_c >= 0 ? CHECKPOINT_SUPERSTEP : CHECKPOINT_FRAGMENT;
+    if (resume && (!read_checkpoint(checkpoint_prefix, rank, size, restart) || restart.info.stage != restart_stage ||
+                   (query_k_c >= 0 && (restart.info.k_c != query_k_c || restart.info.k_f != query_k_f)))) {
+        if (rank == 0) {
+            std::cerr << "No usable checkpoint for this run under " << checkpoint_prefix << std::endl;
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    if (!checkpoint_prefix.empty()) {
+        checkpoints.reset(new CheckpointWriter(checkpoint_prefix, rank, size));
+    }
 
-    // Compute maximal truss numbers for cycle and flow
-    int k_c_max, k_f_max;
-    std::make_tuple(k_c_max, k_f_max)  = distributedMaxTrussNumbers(partitions, rank);
+    // Load graph data (a resumed decomposition needs the layout for the exact refinement)
+    DistGraph D;
+    EdgeSupports supports;
+    {
+        PhaseTimer timer("load");
+        if (generate) {
+            long long m = generate_graph_data(generator, rank, size, D, supports);
+            if (rank == 0) {
+                std::cout << "Generated " << generator.model << " graph: " << (1ll << generator.scale) << " vertices, " << m << " edges" << std::endl;
+            }
+        } else {
+            read_graph_data(input, rank, size, D, supports);
+        }
+    }
+    const DiGraph& G = D.local;
 
-    int superstep = 1;
-    bool terminate = false;
+    if (query_k_c >= 0) {
+        // Prune by degree bounds, then peel only the survivors
+        PeelState state;
+        SuperstepHook after_superstep;
+        if (checkpoints) {
+            after_superstep = [&](const PeelState& s) {
+                if (s.superstep % checkpoint_every == 0) {
+                    CheckpointInfo info = {CHECKPOINT_SUPERSTEP, s.superstep, query_k_c, query_k_f};
+                    PhaseTimer timer("checkpoint");
+                    checkpoints->write(info, G, supports, s.removed);
+                }
+            };
+        }
+        long long survivors;
+        if (resume) {
+            // The layout is rebuilt from the input and must be the one checkpointed
+            if (restart.graph.labels != G.labels || restart.graph.out_offsets != G.out_offsets || restart.graph.out_targets != G.out_targets) {
+                std::cerr << "Rank " << rank << ": checkpoint does not match the input graph" << std::endl;
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            init_peel_state(D, state);
+            state.removed.swap(restart.removed);
+            state.superstep = restart.info.superstep;
+            supports = std::move(restart.supports);
+            distributed_peel(D, supports, state, query_k_c, query_k_f, after_superstep);
+            survivors = count_live_edges(D, state);
+        } else {
+            survivors = truss_query(D, supports, query_k_c, query_k_f, state, after_superstep);
+        }
+        if (checkpoints) {
+            PhaseTimer timer("checkpoint");
+            checkpoints->finish();
+        }
+        if (rank == 0) {
+            std::cout << "(" << query_k_c << ", " << query_k_f << ")-truss: " << survivors << " edges" << std::endl;
+        }
+        if (!output.empty()) {
+            std::vector<ResultRecord> records;
+            for (int e : D.owned_edges) {
+                if (!state.removed[e]) {
+                    records.push_back({G.labels[G.source(e)], G.labels[G.target(e)], supports.cycle[e], supports.flow[e]});
+                }
+            }
+            PhaseTimer timer("output");
+            write_output(records, output, output_format, shard_output, rank);
+        }
+        if (!profile_path.empty()) {
+            profiler().write_summary(profile_path, profile_csv);
+        }
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Trussness upper bounds of the owned edges, lowered to the exact values below
+    Fragment F;
+    PeelProgress progress;
+    int levels_done = 0;
+    std::vector<int> k_c, k_f;
+    TriangleIndex layout_index;
+    TriangleIndex* layout_triangles = nullptr; // layout_index, when it is built
+    if (resume) {
+        F.graph = std::move(restart.graph);
+        progress.values = std::move(restart.supports);
+        progress.removed.swap(restart.removed);
+        progress.cycle_level = restart.info.k_c;
+        progress.flow_level = restart.info.k_f;
+        levels_done = restart.info.superstep;
+        k_c.assign(G.num_edges(), INT_MAX);
+        k_f.assign(G.num_edges(), INT_MAX);
+    } else {
+        // Compute exact supports of owned edges on the distributed layout, and
+        // index their triangles for the h-index rounds in the same pass
+        profiler().begin("supports");
+        if (triangle_index_mb > 0) {
+            layout_triangles = &layout_index;
+        }
+        compute_supports(D, supports, layout_triangles, triangle_index_mb << 20);
+        profiler().end();
+
+        // Cheap trussness upper bounds for the load model
+        profiler().begin("bounds");
+        trussness_upper_bounds(D, supports, bound_rounds, k_c, k_f, layout_triangles);
+        profiler().end();
+
+        // Distributed partitioning: ranks score their owned edges, agree on
+        // boundaries with collectives and migrate each edge to its partition
+        std::vector<int> targets;
+        profiler().begin("partition");
+        if (partitioner_type == TYPE_AWARE_BALANCED) {
+            targets = type_aware_targets(D, supports, 1.1, "c");
+        } else if (partitioner_type == STRATIFIED_BALANCED) {
+            targets = stratified_targets(D, k_c, k_f);
+        }
+        profiler().end();
+        profiler().begin("migrate");
+        migrate_edges(D, supports, targets, F);
+        progress.values = std::move(F.supports);
+        profiler().end();
+    }
+
+    // Peel this rank's partition from the global supports. Triangles across
+    // partitions are missing, so the fragment trussness is an upper bound.
+    {
+        LevelHook after_level;
+        int level_c_max = 0, level_f_max = 0;
+        long long last_peeled = -1;
+        if (checkpoints) {
+            // Every rank steps through the same levels, up to the largest value
+            // on any rank, so the collective checkpoint writes line up. Levels
+            // in which no rank peeled anything are not saved again.
+            std::tie(level_c_max, level_f_max) = distributedMaxTrussNumbers(progress.values.cycle, progress.values.flow);
+            after_level = [&](const PeelProgress& p) {
+                if (++levels_done % checkpoint_every != 0) {
+                    return;
+                }
+                long long peeled = p.peeled;
+                MPI_Allreduce(MPI_IN_PLACE, &peeled, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+                if (peeled != last_peeled) {
+                    last_peeled = peeled;
+                    CheckpointInfo info = {CHECKPOINT_FRAGMENT, levels_done, p.cycle_level, p.flow_level};
+                    PhaseTimer timer("checkpoint");
+                    checkpoints->write(info, F.graph, p.values, p.removed);
+                }
+            };
+            if (!resume) {
+                // Everything up to here is skipped on restart; the file is
+                // written while the local peel runs
+                CheckpointInfo info = {CHECKPOINT_FRAGMENT, 0, progress.cycle_level, progress.flow_level};
+                PhaseTimer timer("checkpoint");
+                checkpoints->write(info, F.graph, progress.values, std::vector<char>(F.graph.num_edges(), 0));
+            }
+        }
+        // Only one index is held at a time, so each gets the whole budget: the
+        // layout's goes before the partition is indexed and is rebuilt below
+        TriangleIndex index;
+        if (triangle_index_mb > 0) {
+            PhaseTimer timer("triangle_index");
+            layout_index = TriangleIndex();
+            layout_triangles = nullptr;
+            build_triangle_index(F.graph, nullptr, triangle_index_mb << 20, index);
+        }
+        {
+            PhaseTimer timer("local_peel");
+            compute_trussness(F.graph, progress, level_c_max, level_f_max, triangle_index_mb > 0 ? &index : nullptr, after_level);
+        }
+        if (checkpoints) {
+            PhaseTimer timer("checkpoint");
+            checkpoints->finish();
+        }
 
-    // Perform local-peel processing on each partition
-    if (rank < size) {
-        std::unordered_set<Edge> F_i = partitions[rank];
-        if (partitioner_type == STRATIFIED_BALANCED) {
-            stratified_local_peel_processing(F_i, cycle_supports, flow_supports, k_c_max, k_f_max, out_neighbors, in_neighbors, LinkSta);
+        // The owners keep the tighter bound and settle on the exact trussness
+        PhaseTimer timer("refine");
+        return_fragment_values(D, F, progress.values.cycle, progress.values.flow, k_c, k_f);
+        F = Fragment();
+        progress = PeelProgress();
+        index = TriangleIndex();
+        if (triangle_index_mb > 0) {
+            layout_triangles = &layout_index;
+            compute_supports(D, supports, layout_triangles, triangle_index_mb << 20);
         }
+        exact_trussness(D, k_c, k_f, layout_triangles);
+    }
+
+    // Compute maximal truss numbers for cycle and flow
+    int k_c_max, k_f_max;
+    {
+        PhaseTimer timer("max_truss");
+        std::tie(k_c_max, k_f_max) = distributedMaxTrussNumbers(k_c, k_f);
+    }
+    if (rank == 0) {
+        std::cout << "Maximal truss numbers: k_c = " << k_c_max << ", k_f = " << k_f_max << std::endl;
     }
 
+    // Write (u, v, k_c, k_f) of this rank's owned edges in original vertex ids
+    if (!output.empty()) {
+        std::vector<ResultRecord> records;
+        records.reserve(D.owned_edges.size());
+        for (int e : D.owned_edges) {
+            records.push_back({G.labels[G.source(e)], G.labels[G.target(e)], k_c[e], k_f[e]});
+        }
+        PhaseTimer timer("output");
+        write_output(records, output, output_format, shard_output, rank);
+    }
+    if (!profile_path.empty()) {
+        profiler().write_summary(profile_path, profile_csv);
+    }
 
     MPI_Finalize();
     return 0;
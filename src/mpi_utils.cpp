@@ -1,50 +1,190 @@
 #include "mpi_utils.h"
 #include <mpi.h>
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 
-vector<Edge> mpi_receive_edges(int rank, int size) {
-    vector<Edge> received_edges;
-    int received_count;
-    MPI_Status status;
-    for (int i = 0; i < size; ++i) {
-        if (i != rank) {
-            MPI_Probe(i, 0, MPI_COMM_WORLD, &status);
-            MPI_Get_count(&status, MPI_BYTE, &received_count);
-            received_edges.resize(received_count / sizeof(Edge));
-            MPI_Recv(received_edges.data(), received_count, MPI_BYTE, i, 0, MPI_COMM_WORLD, &status);
-        }
+MPI_Datatype edge_delta_type() {
+    static MPI_Datatype type = MPI_DATATYPE_NULL;
+    if (type == MPI_DATATYPE_NULL) {
+        int lengths[2] = {2, 2};
+        MPI_Aint displacements[2] = {offsetof(EdgeDelta, u), offsetof(EdgeDelta, cycle_delta)};
+        MPI_Datatype types[2] = {MPI_INT64_T, MPI_INT};
+        MPI_Datatype packed;
+        MPI_Type_create_struct(2, lengths, displacements, types, &packed);
+        MPI_Type_create_resized(packed, 0, sizeof(EdgeDelta), &type);
+        MPI_Type_free(&packed);
+        MPI_Type_commit(&type);
     }
-    return received_edges;
+    return type;
 }
 
-void mpi_send_edges(const vector<Edge>& messages, int rank, int size) {
-    for (int i = 0; i < size; ++i) {
-        if (i != rank) {
-            MPI_Send(messages.data(), messages.size() * sizeof(Edge), MPI_BYTE, i, 0, MPI_COMM_WORLD);
-        }
+vector<EdgeDelta> mpi_exchange_messages(const vector<vector<EdgeDelta>>& messages) {
+    // One personalized all-to-all per superstep; messages[r] holds only the
+    // updates addressed to rank r
+    return alltoallv_exchange(messages, MPI_COMM_WORLD, nullptr, edge_delta_type());
+}
+
+vector<EdgeDelta> mpi_exchange_messages(const vector<vector<EdgeDelta, ArenaAllocator<EdgeDelta>>>& messages) {
+    return alltoallv_exchange(messages, MPI_COMM_WORLD, nullptr, edge_delta_type());
+}
+
+static inline void put_varint(vector<uint8_t>& out, uint64_t x) {
+    while (x >= 0x80) {
+        out.push_back(static_cast<uint8_t>(x) | 0x80);
+        x >>= 7;
     }
+    out.push_back(static_cast<uint8_t>(x));
 }
 
-void collect_results(const vector<Edge>& local_edges, int rank, int size) {
-    if (rank == 0) {
-        vector<Edge> results;
-        results.insert(results.end(), local_edges.begin(), local_edges.end());
+static inline uint64_t get_varint(const uint8_t*& p) {
+    uint64_t x = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        x |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    return x | static_cast<uint64_t>(*p++) << shift;
+}
+
+// Signed values interleaved so that small magnitudes stay short
+static inline uint64_t zigzag(int64_t x) {
+    return (static_cast<uint64_t>(x) << 1) ^ static_cast<uint64_t>(x >> 63);
+}
 
-        for (int i = 1; i < size; ++i) {
-            int received_count;
-            MPI_Status status;
-            MPI_Probe(i, 0, MPI_COMM_WORLD, &status);
-            MPI_Get_count(&status, MPI_BYTE, &received_count);
-            vector<Edge> received_edges(received_count / sizeof(Edge));
-            MPI_Recv(received_edges.data(), received_count, MPI_BYTE, i, 0, MPI_COMM_WORLD, &status);
-            results.insert(results.end(), received_edges.begin(), received_edges.end());
+static inline int64_t unzigzag(uint64_t x) {
+    return static_cast<int64_t>(x >> 1) ^ -static_cast<int64_t>(x & 1);
+}
+
+// Previous ids of the list being encoded or decoded
+struct ArcCursor {
+    VertexId u = 0, v = 0;
+};
+
+static inline void put_arc(vector<uint8_t>& out, ArcCursor& cursor, VertexId u, VertexId v) {
+    put_varint(out, zigzag(u - cursor.u));
+    put_varint(out, zigzag(v - cursor.v));
+    cursor.u = u;
+    cursor.v = v;
+}
+
+static inline void get_arc(const uint8_t*& p, ArcCursor& cursor, VertexId& u, VertexId& v) {
+    u = cursor.u += unzigzag(get_varint(p));
+    v = cursor.v += unzigzag(get_varint(p));
+}
+
+template <typename T, typename Less, typename Encode, typename Decode>
+static vector<T> exchange_encoded(vector<vector<T>>& outgoing, MPI_Comm comm, Less less, Encode encode, Decode decode) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    vector<vector<uint8_t>> bytes(size);
+    for (int r = 0; r < size; ++r) {
+        sort(outgoing[r].begin(), outgoing[r].end(), less);
+        ArcCursor cursor;
+        for (const auto& item : outgoing[r]) {
+            encode(bytes[r], cursor, item);
         }
+        vector<T>().swap(outgoing[r]);
+    }
 
-        // Print results
-        for (const auto& edge : results) {
-            cout << "Edge (" << edge.u << ", " << edge.v << "): Cycle Support = " << edge.cycle_support << ", Flow Support = " << edge.flow_support << endl;
+    vector<int> counts;
+    vector<uint8_t> received = alltoallv_exchange(bytes, comm, &counts);
+    vector<vector<uint8_t>>().swap(bytes);
+
+    vector<T> items;
+    const uint8_t* p = received.data();
+    for (int r = 0; r < size; ++r) {
+        const uint8_t* end = p + counts[r];
+        ArcCursor cursor;
+        while (p < end) {
+            items.push_back(decode(p, cursor));
         }
-    } else {
-        MPI_Send(local_edges.data(), local_edges.size() * sizeof(Edge), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
     }
-}
\ No newline at end of file
+    return items;
+}
+
+vector<pair<VertexId, VertexId>> exchange_arcs(vector<vector<pair<VertexId, VertexId>>>& outgoing, MPI_Comm comm) {
+    typedef pair<VertexId, VertexId> Arc;
+    return exchange_encoded(outgoing, comm, less<Arc>(), [](vector<uint8_t>& out, ArcCursor& cursor, const Arc& arc) {
+        put_arc(out, cursor, arc.first, arc.second);
+    }, [](const uint8_t*& p, ArcCursor& cursor) {
+        Arc arc;
+        get_arc(p, cursor, arc.first, arc.second);
+        return arc;
+    });
+}
+
+vector<EdgeRecord> exchange_edge_records(vector<vector<EdgeRecord>>& outgoing, MPI_Comm comm) {
+    return exchange_encoded(outgoing, comm, [](const EdgeRecord& a, const EdgeRecord& b) {
+        return a.u != b.u ? a.u < b.u : a.v < b.v;
+    }, [](vector<uint8_t>& out, ArcCursor& cursor, const EdgeRecord& edge) {
+        put_arc(out, cursor, edge.u, edge.v);
+        put_varint(out, zigzag(edge.cycle_support));
+        put_varint(out, zigzag(edge.flow_support));
+    }, [](const uint8_t*& p, ArcCursor& cursor) {
+        EdgeRecord edge;
+        get_arc(p, cursor, edge.u, edge.v);
+        edge.cycle_support = static_cast<int>(unzigzag(get_varint(p)));
+        edge.flow_support = static_cast<int>(unzigzag(get_varint(p)));
+        return edge;
+    });
+}
+
+void post_messages(NeighborExchange& exchange, const vector<int>& neighbors, vector<vector<EdgeDelta>>& messages, int tag) {
+    exchange.tag = tag;
+    exchange.pending_receives = static_cast<int>(neighbors.size());
+    exchange.send_buffers.resize(neighbors.size());
+    exchange.send_requests.assign(neighbors.size(), MPI_REQUEST_NULL);
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+        // The buffer must outlive the send, so take ownership of it
+        exchange.send_buffers[i].swap(messages[neighbors[i]]);
+        messages[neighbors[i]].clear();
+        const vector<EdgeDelta>& buffer = exchange.send_buffers[i];
+        MPI_Isend(buffer.data(), static_cast<int>(buffer.size()), edge_delta_type(), neighbors[i], tag, MPI_COMM_WORLD, &exchange.send_requests[i]);
+        profiler().count_sent(static_cast<long long>(buffer.size() * sizeof(EdgeDelta)), 1);
+    }
+}
+
+static void receive_matched(MPI_Message& message, MPI_Status& status, vector<EdgeDelta>& received) {
+    int count;
+    MPI_Get_count(&status, edge_delta_type(), &count);
+    size_t old_size = received.size();
+    received.resize(old_size + count);
+    MPI_Mrecv(received.data() + old_size, count, edge_delta_type(), &message, MPI_STATUS_IGNORE);
+    profiler().count_received(static_cast<long long>(count * sizeof(EdgeDelta)), 1);
+}
+
+bool poll_messages(NeighborExchange& exchange, vector<EdgeDelta>& received) {
+    if (exchange.pending_receives == 0) {
+        return false;
+    }
+    int flag;
+    MPI_Message message;
+    MPI_Status status;
+    MPI_Improbe(MPI_ANY_SOURCE, exchange.tag, MPI_COMM_WORLD, &flag, &message, &status);
+    if (!flag) {
+        return false;
+    }
+    receive_matched(message, status, received);
+    exchange.pending_receives--;
+    return true;
+}
+
+bool wait_message(NeighborExchange& exchange, vector<EdgeDelta>& received) {
+    if (exchange.pending_receives == 0) {
+        return false;
+    }
+    MPI_Message message;
+    MPI_Status status;
+    MPI_Mprobe(MPI_ANY_SOURCE, exchange.tag, MPI_COMM_WORLD, &message, &status);
+    receive_matched(message, status, received);
+    exchange.pending_receives--;
+    return true;
+}
+
+void finish_messages(NeighborExchange& exchange) {
+    MPI_Waitall(static_cast<int>(exchange.send_requests.size()), exchange.send_requests.data(), MPI_STATUSES_IGNORE);
+    for (auto& buffer : exchange.send_buffers) {
+        buffer.clear();
+    }
+}
@@ -1,13 +1,117 @@
 #ifndef MPI_UTILS_H
 #define MPI_UTILS_H
 
+#include <cstdint>
 #include <vector>
+#include <mpi.h>
 #include "graph.h"
+#include "profile.h"
+#include "scratch.h"
 
 using namespace std;
 
-vector<Edge> mpi_receive_edges(int rank, int size);
-void mpi_send_edges(const vector<Edge>& messages, int rank, int size);
-void collect_results(const vector<Edge>& local_edges, int rank, int size);
+// Personalized all-to-all: outgoing[r] is delivered to rank r, and the result
+// holds everything sent to this rank, concatenated in source-rank order.
+// counts_out, if given, receives the number of items from each source.
+// type describes one T; by default T is sent as raw bytes. The lists may
+// come from any allocator, such as an arena.
+template <typename T, typename Alloc>
+vector<T> alltoallv_exchange(const vector<vector<T, Alloc>>& outgoing, MPI_Comm comm, vector<int>* counts_out = nullptr, MPI_Datatype type = MPI_DATATYPE_NULL) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    MPI_Datatype item_type = type;
+    if (type == MPI_DATATYPE_NULL) {
+        MPI_Type_contiguous(sizeof(T), MPI_BYTE, &item_type);
+        MPI_Type_commit(&item_type);
+    }
+
+    vector<int> send_counts(size), recv_counts(size), send_displs(size, 0), recv_displs(size, 0);
+    for (int r = 0; r < size; ++r) {
+        send_counts[r] = static_cast<int>(outgoing[r].size());
+    }
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+
+    vector<T> send_buffer;
+    size_t total_send = 0;
+    for (int r = 0; r < size; ++r) {
+        total_send += outgoing[r].size();
+    }
+    send_buffer.reserve(total_send);
+    for (int r = 0; r < size; ++r) {
+        send_displs[r] = static_cast<int>(send_buffer.size());
+        send_buffer.insert(send_buffer.end(), outgoing[r].begin(), outgoing[r].end());
+    }
+    int total_recv = 0;
+    for (int r = 0; r < size; ++r) {
+        recv_displs[r] = total_recv;
+        total_recv += recv_counts[r];
+    }
+
+    // Traffic to and from other ranks, for the current profiling phase
+    long long sent_items = 0, received_items = 0, sent_messages = 0, received_messages = 0;
+    for (int r = 0; r < size; ++r) {
+        if (r != rank) {
+            sent_items += send_counts[r];
+            received_items += recv_counts[r];
+            sent_messages += send_counts[r] > 0;
+            received_messages += recv_counts[r] > 0;
+        }
+    }
+    int item_bytes;
+    MPI_Type_size(item_type, &item_bytes);
+    profiler().count_sent(sent_items * item_bytes, sent_messages);
+    profiler().count_received(received_items * item_bytes, received_messages);
+
+    vector<T> received(total_recv);
+    MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displs.data(), item_type,
+                  received.data(), recv_counts.data(), recv_displs.data(), item_type, comm);
+    if (type == MPI_DATATYPE_NULL) {
+        MPI_Type_free(&item_type);
+    }
+
+    if (counts_out) {
+        *counts_out = recv_counts;
+    }
+    return received;
+}
+
+// Committed MPI datatype for EdgeDelta (two int64 ids, two int32 deltas),
+// created on first use
+MPI_Datatype edge_delta_type();
+
+vector<EdgeDelta> mpi_exchange_messages(const vector<vector<EdgeDelta>>& messages);
+vector<EdgeDelta> mpi_exchange_messages(const vector<vector<EdgeDelta, ArenaAllocator<EdgeDelta>>>& messages);
+
+// Edge with its supports in original ids, as moved between ranks
+struct EdgeRecord {
+    VertexId u, v;
+    int cycle_support, flow_support;
+};
+
+// Bulk edge exchanges. Each list is sorted and sent as varint-encoded
+// differences of consecutive ids (and varint supports), typically a few bytes
+// per edge instead of two 64-bit ids. The outgoing lists are consumed.
+vector<pair<VertexId, VertexId>> exchange_arcs(vector<vector<pair<VertexId, VertexId>>>& outgoing, MPI_Comm comm);
+vector<EdgeRecord> exchange_edge_records(vector<vector<EdgeRecord>>& outgoing, MPI_Comm comm);
+
+// Nonblocking superstep exchange with a fixed set of neighbor ranks. Every
+// neighbor gets exactly one (possibly empty) message per phase, so receivers
+// know when a phase is complete without a barrier, and messages are consumed
+// in arrival order rather than rank order.
+struct NeighborExchange {
+    vector<MPI_Request> send_requests;
+    vector<vector<EdgeDelta>> send_buffers;
+    int tag = 0;
+    int pending_receives = 0;
+};
+
+void post_messages(NeighborExchange& exchange, const vector<int>& neighbors, vector<vector<EdgeDelta>>& messages, int tag);
+// Append the contents of one arrived message to `received`; false if none has arrived yet
+bool poll_messages(NeighborExchange& exchange, vector<EdgeDelta>& received);
+// Block for the next message; false once every neighbor's message was received
+bool wait_message(NeighborExchange& exchange, vector<EdgeDelta>& received);
+void finish_messages(NeighborExchange& exchange);
 
 #endif // MPI_UTILS_H
\ No newline at end of file
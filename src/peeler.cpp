@@ -1,67 +1,22 @@
 #include "peeler.h"
-#include <unordered_map>
+#include "thread_pool.h"
+#include "profile.h"
+#include "bucket_queue.h"
+#include "scratch.h"
+#include <algorithm>
+#include <climits>
 #include <mpi.h>
 
-void compute_supports(std::vector<Graph>& partitions, int rank) {
-    Graph& F = partitions[rank];
-    std::unordered_map<int, std::unordered_set<int>> out_neighbors;
-    std::unordered_map<int, std::unordered_set<int>> in_neighbors;
+// Edges per work-stealing chunk for peeling rounds
+static const int PEEL_GRAIN = 256;
 
-    // Initialize supports to zero
-    for (auto& edge : F.edges) {
-        edge.cycle_support = 0;
-        edge.flow_support = 0;
-    }
-
-    // Build adjacency lists
-    for (const auto& edge : F.edges) {
-        out_neighbors[edge.u].insert(edge.v);
-        in_neighbors[edge.v].insert(edge.u);
-    }
-
-    // Compute supports
-    for (auto& edge : F.edges) {
-        int u = edge.u;
-        int v = edge.v;
-
-        // Cycle support
-        for (int w : in_neighbors[u]) {
-            if (out_neighbors[v].find(w) != out_neighbors[v].end()) {
-                edge.cycle_support++;
-            }
-        }
-
-        // Flow support
-        for (int w : out_neighbors[u]) {
-            if (in_neighbors[v].find(w) != in_neighbors[v].end()) {
-                edge.flow_support++;
-            }
-        }
-        for (int w : in_neighbors[v]) {
-            if (out_neighbors[u].find(w) != out_neighbors[u].end()) {
-                edge.flow_support++;
-            }
-        }
-        for (int w : out_neighbors[v]) {
-            if (in_neighbors[u].find(w) != in_neighbors[u].end()) {
-                edge.flow_support++;
-            }
-        }
-    }
-
-    // Synchronize supports across all workers
-    int edges_count = F.edges.size();
-    MPI_Allreduce(MPI_IN_PLACE, &edges_count, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-    MPI_Allreduce(MPI_IN_PLACE, F.edges.data(), edges_count * sizeof(Edge), MPI_BYTE, MPI_SUM, MPI_COMM_WORLD);
-}
-
-std::tuple<int, int> distributedMaxTrussNumbers(std::vector<Graph>& partitions, int rank) {
+std::tuple<int, int> distributedMaxTrussNumbers(const std::vector<int>& k_c_bound, const std::vector<int>& k_f_bound) {
     int local_max_k_c = 0, local_max_k_f = 0;
-    for (const auto& edge : G.edges) {
-        for (const auto& pair : edge.pairs) {
-            local_max_k_c = std::max(local_max_k_c, pair.k_c);
-            local_max_k_f = std::max(local_max_k_f, pair.k_f);
-        }
+    for (int k : k_c_bound) {
+        local_max_k_c = std::max(local_max_k_c, k);
+    }
+    for (int k : k_f_bound) {
+        local_max_k_f = std::max(local_max_k_f, k);
     }
 
     int global_max_k_c, global_max_k_f;
@@ -71,134 +26,128 @@ std::tuple<int, int> distributedMaxTrussNumbers(std::vector<Graph>& partitions,
     return std::make_tuple(global_max_k_c, global_max_k_f);
 }
 
-void update_cycle_support(Edge& edge, int new_support) {
-    edge.cycle_support = new_support;
-}
-
-void update_flow_support(Edge& edge, int new_support) {
-    edge.flow_support = new_support;
-}
-
-void UpSupc(Edge& e_star, std::unordered_map<int, std::unordered_set<int>>& out_neighbors, std::unordered_map<int, std::unordered_set<int>>& in_neighbors, std::unordered_map<int, int>& LinkSta) {
-    int u = e_star.u;
-    int v = e_star.v;
-
-    // (1) Zero the cycle support for e_star itself
-    update_cycle_support(e_star, 0);
-
-    // (2) Traverse edges spanned between {u, v} and T_i^io(e_star)
-    for (int h : out_neighbors[u]) {
-        if (out_neighbors[v].find(h) != out_neighbors[v].end()) {
-            // Decrement cycle support for edges incident to h
-            for (auto& edge : edges_incident_to(h)) {
-                update_cycle_support(edge, edge.cycle_support - 1);
-            }
-            // Disqualify u and v in the local indexes of h
-            disqualify_in_local_index(h, u, v);
+// Buffers of the bucket peel, sized once per graph and reused by the cycle and
+// flow peels and by every level of each
+struct PeelScratch {
+    std::vector<char> in_frontier, touched;
+    WorkerScratch<int> local_touched;  // per pool worker
+    std::vector<int> frontier, next_frontier;
+    BucketQueue buckets;
+};
+
+// Level-synchronous bucket peeling of the live edges of G for one triangle
+// type, continuing after the last completed level. Edges sit in buckets
+// indexed by their remaining support and each level only drains its own
+// bucket. Frontier edges are peeled concurrently: a triangle holding several
+// frontier edges is charged only by its lowest-id frontier edge, frontier
+// partners are never decremented, and supports are clamped at the current
+// level. A peeled edge keeps the level as its value.
+template <typename Visit>
+static void bucket_peel(const DiGraph& G, Visit visit, PeelProgress& progress, std::vector<int> EdgeSupports::*type, int PeelProgress::*level_done,
+                        int max_level, PeelScratch& scratch, const LevelHook& after_level) {
+    ThreadPool& pool = thread_pool();
+    int m = G.num_edges();
+    std::vector<int>& support = progress.values.*type;
+    std::vector<char>& removed = progress.removed;
+    std::vector<char>& in_frontier = scratch.in_frontier;
+    std::vector<char>& touched = scratch.touched;
+    WorkerScratch<int>& local_touched = scratch.local_touched;
+    std::vector<int>& frontier = scratch.frontier;
+    std::vector<int>& next_frontier = scratch.next_frontier;
+    BucketQueue& buckets = scratch.buckets;
+    if (progress.*level_done < 0) {
+        removed.assign(m, 0);
+    }
+    in_frontier.assign(m, 0);
+    touched.assign(m, 0);
+    local_touched.resize(pool.size());
+    buckets.clear();
+
+    size_t remaining = 0;
+    for (int e = 0; e < m; ++e) {
+        if (!removed[e]) {
+            buckets.push(e, std::max(0, support[e]));
+            remaining++;
         }
     }
 
-    // Update LinkSta because of the removed edge e_star
-    LinkSta[u * num_vertices + v] = 0;
-    LinkSta[v * num_vertices + u] = 0;
-}
-
-void UpSupf(Edge& e_star, std::unordered_map<int, std::unordered_set<int>>& out_neighbors, std::unordered_map<int, std::unordered_set<int>>& in_neighbors, std::unordered_map<int, int>& LinkSta) {
-    int u = e_star.u;
-    int v = e_star.v;
+    for (int level = progress.*level_done + 1; remaining > 0 || (after_level && level <= max_level); ++level) {
+        if (!after_level) {
+            // Nobody watches the levels, so skip straight to the next non-empty one
+            level = buckets.next_level(level);
+        }
 
-    // (1) Zero the flow support for e_star itself
-    update_flow_support(e_star, 0);
+        // Keep the live entries of the level's bucket
+        buckets.take(level, next_frontier);
+        frontier.clear();
+        for (int e : next_frontier) {
+            if (!removed[e] && !in_frontier[e] && support[e] <= level) {
+                in_frontier[e] = 1;
+                frontier.push_back(e);
+            }
+        }
 
-    if (LinkSta[u * num_vertices + v] == 1 || LinkSta[v * num_vertices + u] == 1) {
-        // (2) If u and v are uni-linked
-        for (int h : in_neighbors[u]) {
-            if (in_neighbors[v].find(h) != in_neighbors[v].end()) {
-                // Decrement flow support for edges incident to h
-                for (auto& edge : edges_incident_to(h)) {
-                    update_flow_support(edge, edge.flow_support - 1);
+        while (!frontier.empty()) {
+            pool.parallel_for(0, static_cast<int>(frontier.size()), PEEL_GRAIN, [&](int begin, int end, int worker) {
+                for (int i = begin; i < end; ++i) {
+                    int e = frontier[i];
+                    visit(G, e, &removed, [&](int e1, int e2) {
+                        if ((in_frontier[e1] && e1 < e) || (in_frontier[e2] && e2 < e)) {
+                            return;
+                        }
+                        for (int f : {e1, e2}) {
+                            if (!in_frontier[f] && atomic_decrement_above(support[f], level)
+                                && !__atomic_exchange_n(&touched[f], 1, __ATOMIC_RELAXED)) {
+                                local_touched[worker].push_back(f);
+                            }
+                        }
+                    });
                 }
-                // Disqualify u and v in the local indexes of h
-                disqualify_in_local_index(h, u, v);
+            });
+
+            // Retire the frontier
+            for (int e : frontier) {
+                support[e] = level;
+                removed[e] = 1;
+                in_frontier[e] = 0;
             }
-        }
-    } else if (LinkSta[u * num_vertices + v] == 2 && LinkSta[v * num_vertices + u] == 2) {
-        // (3) If u and v are bi-linked
-        for (int h : out_neighbors[u]) {
-            if (out_neighbors[v].find(h) != out_neighbors[v].end()) {
-                // Decrement flow support for edges incident to h
-                for (auto& edge : edges_incident_to(h)) {
-                    update_flow_support(edge, edge.flow_support - 1);
+            remaining -= frontier.size();
+            progress.peeled += static_cast<long long>(frontier.size());
+            profiler().count_peeled(static_cast<long long>(frontier.size()));
+
+            // Re-file decremented edges; those that reached this level peel next
+            next_frontier.clear();
+            for (int w = 0; w < local_touched.size(); ++w) {
+                for (int f : local_touched[w]) {
+                    touched[f] = 0;
+                    if (support[f] <= level) {
+                        in_frontier[f] = 1;
+                        next_frontier.push_back(f);
+                    } else {
+                        buckets.push(f, support[f]);
+                    }
                 }
-                // Disqualify u and v in the local indexes of h
-                disqualify_in_local_index(h, u, v);
             }
+            local_touched.clear();
+            frontier.swap(next_frontier);
         }
-    }
-
-    // Update LinkSta because of the removed edge e_star
-    LinkSta[u * num_vertices + v] = 0;
-    LinkSta[v * num_vertices + u] = 0;
-}
-
-void perform_flow_decomposition(std::unordered_set<Edge>& edges, std::unordered_map<int, std::unordered_set<int>>& out_neighbors, std::unordered_map<int, std::unordered_set<int>>& in_neighbors, std::unordered_map<int, int>& LinkSta) {
-    // Initialize k_f to 0
-    int k_f = 0;
 
-    // Continue until all edges are peeled
-    while (!edges.empty()) {
-        // Peel edges with unqualified flow support
-        for (auto it = edges.begin(); it != edges.end(); ) {
-            if (it->flow_support < k_f) {
-                UpSupf(*it, out_neighbors, in_neighbors, LinkSta);
-                it = edges.erase(it);
-            } else {
-                ++it;
-            }
+        progress.*level_done = level;
+        if (after_level) {
+            after_level(progress);
         }
-
-        // Increase k_f
-        k_f++;
     }
+    progress.*level_done = INT_MAX;
 }
 
-void stratified_local_peel_processing(std::unordered_set<Edge>& F_i, const std::unordered_map<Edge, int>& cycle_supports, const std::unordered_map<Edge, int>& flow_supports, int k_c, int k_f, std::unordered_map<int, std::unordered_set<int>>& out_neighbors, std::unordered_map<int, std::unordered_set<int>>& in_neighbors, std::unordered_map<int, int>& LinkSta) {
-    // Implementation of the stratified local-peel processing logic
-    // Ensure that all edges which form a flow triangle within the interval on each fragment are included
-    std::unordered_set<Edge> F_i_alpha;
-
-    for (const auto& edge : F_i) {
-        // Check if the edge forms a flow triangle within the interval
-        if (is_flow_triangle_within_interval(edge, F_i)) {
-            F_i_alpha.insert(edge);
-        }
+void compute_trussness(const DiGraph& G, PeelProgress& progress, int k_c_max, int k_f_max, const TriangleIndex* index, const LevelHook& after_level) {
+    // Cycle and flow trussness peel independently, one after the other; the
+    // second peel reuses the buffers of the first
+    PeelScratch scratch;
+    if (progress.cycle_level != INT_MAX) {
+        bucket_peel(G, IndexedCycleTriangles{index}, progress, &EdgeSupports::cycle, &PeelProgress::cycle_level, k_c_max, scratch, after_level);
     }
-
-    // Update cycle support for edges in F_i_alpha
-    for (const auto& edge : F_i_alpha) {
-        if (cycle_supports.find(edge) != cycle_supports.end()) {
-            // Update cycle support for the edge
-            update_cycle_support(edge, cycle_supports.at(edge));
-        }
+    if (progress.flow_level != INT_MAX) {
+        bucket_peel(G, IndexedFlowTriangles{index}, progress, &EdgeSupports::flow, &PeelProgress::flow_level, k_f_max, scratch, after_level);
     }
-
-    // Update flow support for edges in F_i_alpha
-    for (const auto& edge : F_i_alpha) {
-        if (flow_supports.find(edge) != flow_supports.end()) {
-            // Update flow support for the edge
-            update_flow_support(edge, flow_supports.at(edge));
-        }
-    }
-
-    // Perform flow decomposition by lines 1-6 of Alg.~\ref{algo:disbatpeel}
-    perform_flow_decomposition(F_i_alpha, out_neighbors, in_neighbors, LinkSta);
-
-    // Peel edges based on the updated cycle and flow supports
-    for (auto it = F_i.begin(); it != F_i.end(); ) {
-        if (it->cycle_support < k_c || it->flow_support < k_f) {
-            it = F_i.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
\ No newline at end of file
+}
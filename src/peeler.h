@@ -1,28 +1,41 @@
 #ifndef PEELER_H
 #define PEELER_H
 
-#include <unordered_set>
-#include <unordered_map>
+#include <functional>
 #include <vector>
+#include <tuple>
 #include <mpi.h>
+#include "digraph.h"
+#include "graph.h"
+#include "triangles.h"
 
-struct Edge {
-    int u, v;
-    int cycle_support;
-    int flow_support;
+// Global maxima of per-edge trussness values (or of upper bounds on them)
+std::tuple<int, int> distributedMaxTrussNumbers(const std::vector<int>& k_c_bound, const std::vector<int>& k_f_bound);
+// State of compute_trussness. values holds, per edge and type, the trussness
+// once the edge is peeled and its remaining support until then. The levels are
+// the last ones each peel completed (-1 before it starts, INT_MAX once it is
+// done), and removed flags the edges gone in the peel under way. peeled
+// counts the edges peeled by this call, over both types.
+struct PeelProgress {
+    EdgeSupports values;
+    int cycle_level = -1;
+    int flow_level = -1;
+    std::vector<char> removed;
+    long long peeled = 0;
 };
 
-struct Graph {
-    std::vector<Edge> edges;
-};
+// Called after every level of the cycle peel, then of the flow peel
+typedef std::function<void(const PeelProgress&)> LevelHook;
 
-void compute_supports(std::vector<Graph>& partitions, int rank);
-std::tuple<int, int> distributedMaxTrussNumbers(std::vector<Graph>& partitions, int rank);
-void update_cycle_support(Edge& edge, int new_support);
-void update_flow_support(Edge& edge, int new_support);
-void UpSupc(Edge& e_star, std::unordered_map<int, std::unordered_set<int>>& out_neighbors, std::unordered_map<int, std::unordered_set<int>>& in_neighbors, std::unordered_map<int, int>& LinkSta);
-void UpSupf(Edge& e_star, std::unordered_map<int, std::unordered_set<int>>& out_neighbors, std::unordered_map<int, std::unordered_set<int>>& in_neighbors, std::unordered_map<int, int>& LinkSta);
-void perform_flow_decomposition(std::unordered_set<Edge>& edges, std::unordered_map<int, std::unordered_set<int>>& out_neighbors, std::unordered_map<int, std::unordered_set<int>>& in_neighbors, std::unordered_map<int, int>& LinkSta);
-void stratified_local_peel_processing(std::unordered_set<Edge>& F_i, const std::unordered_map<Edge, int>& cycle_supports, const std::unordered_map<Edge, int>& flow_supports, int k_c, int k_f, std::unordered_map<int, std::unordered_set<int>>& out_neighbors, std::unordered_map<int, std::unordered_set<int>>& in_neighbors, std::unordered_map<int, int>& LinkSta);
+// Cycle and flow trussness of every edge of G by bucket peeling, computed in
+// place in progress.values from the supports or from a saved progress. On a
+// fragment, whose supports are global but whose cross-partition triangles are
+// missing, the results are upper bounds of the trussness (exact for a single
+// partition). With an index, triangles of indexed edges are read from it
+// instead of being enumerated. With after_level, every level up to k_c_max
+// and k_f_max is reported, empty or not, so ranks passing the same maxima
+// (at least the largest values) make the same calls.
+void compute_trussness(const DiGraph& G, PeelProgress& progress, int k_c_max, int k_f_max, const TriangleIndex* index = nullptr,
+                       const LevelHook& after_level = nullptr);
 
 #endif // PEELER_H
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "profile.h"
+#include <mpi.h>
+#include <sys/resource.h>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+// Counters reduced across ranks, in output order
+static const int NUM_METRICS = 7;
+static const char* METRIC_NAMES[NUM_METRICS] = {
+    "seconds", "bytes_sent", "bytes_received", "messages_sent", "messages_received", "edges_peeled", "peak_rss_kb"};
+
+static void metric_values(const PhaseStats& s, double* values) {
+    values[0] = s.seconds;
+    values[1] = static_cast<double>(s.bytes_sent);
+    values[2] = static_cast<double>(s.bytes_received);
+    values[3] = static_cast<double>(s.messages_sent);
+    values[4] = static_cast<double>(s.messages_received);
+    values[5] = static_cast<double>(s.edges_peeled);
+    values[6] = static_cast<double>(s.peak_rss_kb);
+}
+
+static long long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;  // kilobytes on Linux
+}
+
+Profiler& profiler() {
+    static Profiler instance;
+    return instance;
+}
+
+int Profiler::phase(const string& name) {
+    auto it = index.find(name);
+    if (it != index.end()) {
+        return it->second;
+    }
+    index[name] = static_cast<int>(phases.size());
+    names.push_back(name);
+    phases.emplace_back();
+    return static_cast<int>(phases.size()) - 1;
+}
+
+void Profiler::begin(const string& name) {
+    open.push_back({phase(name), MPI_Wtime()});
+}
+
+void Profiler::end() {
+    PhaseStats& s = phases[open.back().first];
+    s.calls++;
+    s.seconds += MPI_Wtime() - open.back().second;
+    s.peak_rss_kb = peak_rss_kb();
+    open.pop_back();
+}
+
+PhaseStats& Profiler::current() {
+    // Traffic outside any phase is kept under "other"
+    return phases[open.empty() ? phase("other") : open.back().first];
+}
+
+void Profiler::count_sent(long long bytes, long long messages) {
+    PhaseStats& s = current();
+    s.bytes_sent += bytes;
+    s.messages_sent += messages;
+}
+
+void Profiler::count_received(long long bytes, long long messages) {
+    PhaseStats& s = current();
+    s.bytes_received += bytes;
+    s.messages_received += messages;
+}
+
+void Profiler::count_peeled(long long edges) {
+    current().edges_peeled += edges;
+}
+
+void Profiler::write_summary(const string& path, bool csv) const {
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Rank 0's phase list is the reference; phases a rank never entered count as zero
+    string joined;
+    for (const auto& name : names) {
+        joined += name + '\n';
+    }
+    int length = static_cast<int>(joined.size());
+    MPI_Bcast(&length, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    joined.resize(length);
+    MPI_Bcast(&joined[0], length, MPI_CHAR, 0, MPI_COMM_WORLD);
+    vector<string> phase_names;
+    for (size_t start = 0, stop; (stop = joined.find('\n', start)) != string::npos; start = stop + 1) {
+        phase_names.push_back(joined.substr(start, stop - start));
+    }
+
+    int n = static_cast<int>(phase_names.size());
+    vector<double> local(n * NUM_METRICS, 0.0), low(n * NUM_METRICS), high(n * NUM_METRICS), sum(n * NUM_METRICS);
+    vector<int> calls(n, 0);
+    for (int i = 0; i < n; ++i) {
+        auto it = index.find(phase_names[i]);
+        if (it != index.end()) {
+            metric_values(phases[it->second], &local[i * NUM_METRICS]);
+            calls[i] = phases[it->second].calls;
+        }
+    }
+    MPI_Reduce(local.data(), low.data(), n * NUM_METRICS, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(local.data(), high.data(), n * NUM_METRICS, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(local.data(), sum.data(), n * NUM_METRICS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : calls.data(), calls.data(), n, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (rank != 0) {
+        return;
+    }
+
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) {
+        cerr << "Failed to open file: " << path << endl;
+        return;
+    }
+    if (csv) {
+        fprintf(out, "phase,calls,metric,min,max,avg,imbalance\n");
+    } else {
+        fprintf(out, "{\n  \"ranks\": %d,\n  \"phases\": [", size);
+    }
+    for (int i = 0; i < n; ++i) {
+        if (!csv) {
+            fprintf(out, "%s\n    {\"name\": \"%s\", \"calls\": %d", i ? "," : "", phase_names[i].c_str(), calls[i]);
+        }
+        for (int k = 0; k < NUM_METRICS; ++k) {
+            int j = i * NUM_METRICS + k;
+            double avg = sum[j] / size;
+            double imbalance = avg > 0 ? high[j] / avg : 1.0;
+            if (csv) {
+                fprintf(out, "%s,%d,%s,%.9g,%.9g,%.9g,%.4f\n", phase_names[i].c_str(), calls[i], METRIC_NAMES[k], low[j], high[j], avg, imbalance);
+            } else {
+                fprintf(out, ",\n     \"%s\": {\"min\": %.9g, \"max\": %.9g, \"avg\": %.9g, \"imbalance\": %.4f}",
+                        METRIC_NAMES[k], low[j], high[j], avg, imbalance);
+            }
+        }
+        if (!csv) {
+            fprintf(out, "}");
+        }
+    }
+    if (!csv) {
+        fprintf(out, "\n  ]\n}\n");
+    }
+    fclose(out);
+}
@@ -0,0 +1,55 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Counters of one phase on one rank. Traffic excludes messages to self.
+struct PhaseStats {
+    int calls = 0;
+    double seconds = 0;
+    long long bytes_sent = 0, bytes_received = 0;
+    long long messages_sent = 0, messages_received = 0;
+    long long edges_peeled = 0;
+    long long peak_rss_kb = 0;  // process high-water mark when the phase last ended
+};
+
+// Per-rank phase timers and counters. Phases are opened with PhaseTimer and
+// may nest; traffic and peeled edges are charged to the innermost open phase,
+// and time to every open phase. Only the thread that calls MPI records.
+class Profiler {
+public:
+    void begin(const std::string& name);
+    void end();
+
+    void count_sent(long long bytes, long long messages);
+    void count_received(long long bytes, long long messages);
+    void count_peeled(long long edges);
+
+    // Summary over ranks: min, max, avg and max/avg imbalance of every counter
+    // of every phase, written by rank 0 as JSON or CSV. Collective.
+    void write_summary(const std::string& path, bool csv) const;
+
+private:
+    int phase(const std::string& name);
+    PhaseStats& current();
+
+    std::vector<std::string> names;  // in order of first use
+    std::vector<PhaseStats> phases;
+    std::unordered_map<std::string, int> index;
+    std::vector<std::pair<int, double>> open;  // (phase, start time)
+};
+
+// Process-wide profiler, like thread_pool()
+Profiler& profiler();
+
+class PhaseTimer {
+public:
+    explicit PhaseTimer(const std::string& name) { profiler().begin(name); }
+    ~PhaseTimer() { profiler().end(); }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
+#endif // PROFILE_H
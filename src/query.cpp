@@ -0,0 +1,92 @@
+#include "query.h"
+#include "mpi_utils.h"
+#include "profile.h"
+#include <mpi.h>
+#include <algorithm>
+
+// Degree pruning rounds before switching to exact supports
+static const int DEGREE_ROUNDS = 8;
+
+long long prune_by_degree(const DistGraph& D, int k_c, int k_f, PeelState& state, int max_rounds) {
+    const DiGraph& G = D.local;
+    vector<char>& removed = state.removed;
+    vector<int> out_deg(G.num_vertices), in_deg(G.num_vertices);
+    long long total = 0;
+
+    for (int round = 0; round < max_rounds; ++round) {
+        // Owned and ghost vertices hold their full adjacency, so live degrees are exact
+        fill(out_deg.begin(), out_deg.end(), 0);
+        fill(in_deg.begin(), in_deg.end(), 0);
+        for (int e = 0; e < G.num_edges(); ++e) {
+            if (!removed[e]) {
+                out_deg[G.source(e)]++;
+                in_deg[G.target(e)]++;
+            }
+        }
+
+        vector<vector<EdgeDelta>> messages(D.size);
+        vector<int> holders;
+        long long local_count = 0;
+        for (int e : D.owned_edges) {
+            if (removed[e]) {
+                continue;
+            }
+            int u = G.source(e), v = G.target(e);
+            int cycle_bound = min(in_deg[u], out_deg[v]);
+            int flow_bound = min(out_deg[u] - 1, in_deg[v] - 1) + min(in_deg[u], in_deg[v] - 1) + min(out_deg[u] - 1, out_deg[v]);
+            if (cycle_bound >= k_c && flow_bound >= k_f) {
+                continue;
+            }
+            removed[e] = 1;
+            local_count++;
+            profiler().count_peeled(1);
+            D.arc_holders(e, holders);
+            for (int r : holders) {
+                messages[r].push_back({G.labels[u], G.labels[v], 0, 0});
+            }
+        }
+        for (const auto& notice : mpi_exchange_messages(messages)) {
+            int e = local_edge_id(D, notice.u, notice.v);
+            if (e >= 0) {
+                removed[e] = 1;
+            }
+        }
+
+        long long global_count = 0;
+        MPI_Allreduce(&local_count, &global_count, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        total += global_count;
+        if (global_count == 0) {
+            break;
+        }
+    }
+    return total;
+}
+
+void compute_live_supports(const DistGraph& D, const PeelState& state, EdgeSupports& supports) {
+    // Pruned edges count as absent, so one triangle pass gives the supports among survivors
+    compute_owned_supports(D, &state.removed, supports);
+}
+
+long long truss_query(const DistGraph& D, EdgeSupports& supports, int k_c, int k_f, PeelState& state, const SuperstepHook& after_superstep) {
+    init_peel_state(D, state);
+    {
+        PhaseTimer timer("prune");
+        prune_by_degree(D, k_c, k_f, state, DEGREE_ROUNDS);
+    }
+    {
+        PhaseTimer timer("live_supports");
+        supports.assign(D.local.num_edges());
+        compute_live_supports(D, state, supports);
+    }
+    distributed_peel(D, supports, state, k_c, k_f, after_superstep);
+    return count_live_edges(D, state);
+}
+
+long long count_live_edges(const DistGraph& D, const PeelState& state) {
+    long long local_count = 0, global_count = 0;
+    for (int e : D.owned_edges) {
+        local_count += !state.removed[e];
+    }
+    MPI_Allreduce(&local_count, &global_count, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    return global_count;
+}
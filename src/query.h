@@ -0,0 +1,29 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <vector>
+#include "graph.h"
+#include "superstep.h"
+
+// Degree bounds on the supports of an owned edge (u, v), from the live
+// degrees of its endpoints:
+//   cycle <= min(in(u), out(v))
+//   flow  <= min(out(u) - 1, in(v) - 1) + min(in(u), in(v) - 1) + min(out(u) - 1, out(v))
+// Owned edges that cannot reach (k_c, k_f) are marked removed and the other
+// holders of each arc are told, so degrees stay consistent everywhere.
+// Repeats while anything is removed, up to max_rounds. Returns the number of
+// edges removed globally.
+long long prune_by_degree(const DistGraph& D, int k_c, int k_f, PeelState& state, int max_rounds);
+
+// Supports of live owned edges, counting only triangles with no removed arc
+void compute_live_supports(const DistGraph& D, const PeelState& state, EdgeSupports& supports);
+
+// The (k_c, k_f)-truss alone: degree pruning, supports of the survivors, then
+// the distributed peel. Live owned edges in `state` form the answer; returns
+// its global edge count.
+long long truss_query(const DistGraph& D, EdgeSupports& supports, int k_c, int k_f, PeelState& state, const SuperstepHook& after_superstep = nullptr);
+
+// Global number of live owned edges
+long long count_live_edges(const DistGraph& D, const PeelState& state);
+
+#endif // QUERY_H
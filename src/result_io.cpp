@@ -0,0 +1,264 @@
+#include "result_io.h"
+#include <mpi.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <queue>
+
+using namespace std;
+
+const char BINARY_RESULT_MAGIC[8] = {'D', 'D', 'T', 'R', 'E', 'S', 'L', '2'};
+
+// Largest single MPI-IO transfer, kept below INT_MAX bytes
+static const uint64_t IO_CHUNK_BYTES = 1 << 30;
+
+// stdio buffer for shard and merge output
+static const size_t STDIO_BUFFER_BYTES = 1 << 22;
+
+static void append_int(string& out, long long value) {
+    char digits[20];
+    int n = 0;
+    unsigned long long x = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+    do {
+        digits[n++] = static_cast<char>('0' + x % 10);
+        x /= 10;
+    } while (x);
+    if (value < 0) {
+        out.push_back('-');
+    }
+    while (n) {
+        out.push_back(digits[--n]);
+    }
+}
+
+static void append_text(string& out, const ResultRecord& r) {
+    append_int(out, r.u);
+    out.push_back(' ');
+    append_int(out, r.v);
+    out.push_back(' ');
+    append_int(out, r.k_c);
+    out.push_back(' ');
+    append_int(out, r.k_f);
+    out.push_back('\n');
+}
+
+static bool record_less(const ResultRecord& a, const ResultRecord& b) {
+    return a.u != b.u ? a.u < b.u : a.v < b.v;
+}
+
+static BinaryResultHeader make_header(uint64_t num_records) {
+    BinaryResultHeader header;
+    memcpy(header.magic, BINARY_RESULT_MAGIC, sizeof(header.magic));
+    header.num_records = num_records;
+    return header;
+}
+
+void write_results(const vector<ResultRecord>& records, const string& path, OutputFormat format) {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    // Format locally; binary records are written straight from the vector
+    string text;
+    const char* data = reinterpret_cast<const char*>(records.data());
+    uint64_t bytes = records.size() * sizeof(ResultRecord);
+    if (format == TEXT_OUTPUT) {
+        text.reserve(records.size() * 32);
+        for (const auto& r : records) {
+            append_text(text, r);
+        }
+        data = text.data();
+        bytes = text.size();
+    }
+
+    uint64_t offset = 0, max_bytes = 0, total_records = records.size();
+    MPI_Exscan(&bytes, &offset, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0) {
+        offset = 0;
+    }
+    MPI_Allreduce(&bytes, &max_bytes, 1, MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &total_records, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, path.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        cerr << "Failed to open file: " << path << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(fh, 0);
+
+    MPI_Offset base = 0;
+    if (format == BINARY_OUTPUT) {
+        base = sizeof(BinaryResultHeader);
+        if (rank == 0) {
+            BinaryResultHeader header = make_header(total_records);
+            MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+    }
+
+    // Every rank takes part in the same number of collective writes
+    for (uint64_t done = 0; done < max_bytes; done += IO_CHUNK_BYTES) {
+        uint64_t n = done < bytes ? min(IO_CHUNK_BYTES, bytes - done) : 0;
+        MPI_File_write_at_all(fh, base + offset + min(done, bytes), data + min(done, bytes), static_cast<int>(n), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+    MPI_File_close(&fh);
+}
+
+void write_result_shard(vector<ResultRecord>& records, const string& prefix, int rank, OutputFormat format) {
+    sort(records.begin(), records.end(), record_less);
+
+    string path = prefix + "." + to_string(rank);
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) {
+        cerr << "Failed to open file: " << path << endl;
+        return;
+    }
+    setvbuf(out, nullptr, _IOFBF, STDIO_BUFFER_BYTES);
+
+    if (format == BINARY_OUTPUT) {
+        BinaryResultHeader header = make_header(records.size());
+        fwrite(&header, sizeof(header), 1, out);
+        fwrite(records.data(), sizeof(ResultRecord), records.size(), out);
+    } else {
+        string text;
+        for (const auto& r : records) {
+            append_text(text, r);
+            if (text.size() >= STDIO_BUFFER_BYTES) {
+                fwrite(text.data(), 1, text.size(), out);
+                text.clear();
+            }
+        }
+        fwrite(text.data(), 1, text.size(), out);
+    }
+    fclose(out);
+}
+
+// Sequential reader for either result format
+class RecordReader {
+public:
+    // Owns the open file, so it is never copied
+    RecordReader() = default;
+    RecordReader(const RecordReader&) = delete;
+    RecordReader& operator=(const RecordReader&) = delete;
+
+    bool open(const string& path) {
+        file = fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        setvbuf(file, nullptr, _IOFBF, STDIO_BUFFER_BYTES);
+        BinaryResultHeader header;
+        if (fread(&header, sizeof(header), 1, file) == 1) {
+            binary = memcmp(header.magic, BINARY_RESULT_MAGIC, sizeof(header.magic)) == 0;
+        }
+        if (!binary) {
+            rewind(file);
+        }
+        return true;
+    }
+
+    bool next(ResultRecord& r) {
+        if (binary) {
+            return fread(&r, sizeof(r), 1, file) == 1;
+        }
+        char line[128];
+        while (fgets(line, sizeof(line), file)) {
+            char* p = line;
+            char* q;
+            long long values[4];
+            int n = 0;
+            for (; n < 4; ++n) {
+                values[n] = strtoll(p, &q, 10);
+                if (q == p) {
+                    break;
+                }
+                p = q;
+            }
+            if (n == 4) {
+                r = {values[0], values[1], static_cast<int>(values[2]), static_cast<int>(values[3])};
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ~RecordReader() {
+        if (file) {
+            fclose(file);
+        }
+    }
+
+private:
+    FILE* file = nullptr;
+    bool binary = false;
+};
+
+bool merge_result_shards(const string& prefix, int num_shards, const string& output, OutputFormat format) {
+    vector<RecordReader> readers(num_shards);
+    typedef pair<ResultRecord, int> Head;
+    auto later = [](const Head& a, const Head& b) { return record_less(b.first, a.first); };
+    priority_queue<Head, vector<Head>, decltype(later)> heads(later);
+    for (int s = 0; s < num_shards; ++s) {
+        // A missing shard would silently truncate the result
+        string path = prefix + "." + to_string(s);
+        if (!readers[s].open(path)) {
+            cerr << "Failed to open file: " << path << endl;
+            return false;
+        }
+        ResultRecord r;
+        if (readers[s].next(r)) {
+            heads.push({r, s});
+        }
+    }
+
+    FILE* out = fopen(output.c_str(), "wb");
+    if (!out) {
+        cerr << "Failed to open file: " << output << endl;
+        return false;
+    }
+    setvbuf(out, nullptr, _IOFBF, STDIO_BUFFER_BYTES);
+    BinaryResultHeader header = make_header(0);
+    if (format == BINARY_OUTPUT) {
+        fwrite(&header, sizeof(header), 1, out);
+    }
+
+    string text;
+    while (!heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        if (format == BINARY_OUTPUT) {
+            fwrite(&head.first, sizeof(ResultRecord), 1, out);
+        } else {
+            append_text(text, head.first);
+            if (text.size() >= STDIO_BUFFER_BYTES) {
+                fwrite(text.data(), 1, text.size(), out);
+                text.clear();
+            }
+        }
+        header.num_records++;
+        ResultRecord r;
+        if (readers[head.second].next(r)) {
+            heads.push({r, head.second});
+        }
+    }
+    fwrite(text.data(), 1, text.size(), out);
+
+    if (format == BINARY_OUTPUT) {
+        fseek(out, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, out);
+    }
+    fclose(out);
+    return true;
+}
+
+bool read_results(const string& path, vector<ResultRecord>& records) {
+    RecordReader reader;
+    if (!reader.open(path)) {
+        return false;
+    }
+    ResultRecord r;
+    while (reader.next(r)) {
+        records.push_back(r);
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef RESULT_IO_H
+#define RESULT_IO_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "digraph.h"
+
+// Per-edge decomposition result with original vertex ids
+struct ResultRecord {
+    VertexId u, v;
+    int k_c, k_f;
+};
+
+enum OutputFormat {
+    TEXT_OUTPUT,   // one "u v k_c k_f" line per edge
+    BINARY_OUTPUT  // header followed by packed records: int64 u, v, int32 k_c, k_f
+};
+
+struct BinaryResultHeader {
+    char magic[8];
+    uint64_t num_records;
+};
+
+extern const char BINARY_RESULT_MAGIC[8];
+
+// Shared-file output: every rank formats its records locally and writes them at
+// its exclusive-prefix-sum offset with collective MPI-IO writes.
+void write_results(const std::vector<ResultRecord>& records, const std::string& path, OutputFormat format);
+
+// Per-rank shard "<prefix>.<rank>", written with buffered stdio; records are
+// sorted by (u, v) first so shards can be merged.
+void write_result_shard(std::vector<ResultRecord>& records, const std::string& prefix, int rank, OutputFormat format);
+
+// Streaming k-way merge of sorted shards into one sorted file (single process).
+// Returns false if a shard or the output cannot be opened.
+bool merge_result_shards(const std::string& prefix, int num_shards, const std::string& output, OutputFormat format);
+
+// Read a result file or shard written in either format
+bool read_results(const std::string& path, std::vector<ResultRecord>& records);
+
+#endif // RESULT_IO_H
@@ -0,0 +1,46 @@
+#include "scratch.h"
+#include <algorithm>
+
+using namespace std;
+
+static size_t aligned_offset(const char* base, size_t used, size_t align) {
+    size_t address = reinterpret_cast<size_t>(base) + used;
+    return used + (align - address % align) % align;
+}
+
+void* MonotonicArena::allocate(size_t bytes, size_t align) {
+    // Move on to the next kept chunk when the current one is full
+    while (current < chunks.size()) {
+        Chunk& chunk = chunks[current];
+        size_t offset = aligned_offset(chunk.data.get(), used, align);
+        if (offset + bytes <= chunk.size) {
+            used = offset + bytes;
+            return chunk.data.get() + offset;
+        }
+        current++;
+        used = 0;
+    }
+
+    // Out of chunks: add one, big enough for an oversized request
+    size_t size = max(chunk_bytes, bytes + align);
+    chunks.push_back({unique_ptr<char[]>(new char[size]), size});
+    return allocate(bytes, align);
+}
+
+void MonotonicArena::reset() {
+    current = 0;
+    used = 0;
+}
+
+void MonotonicArena::release() {
+    vector<Chunk>().swap(chunks);
+    reset();
+}
+
+size_t MonotonicArena::reserved_bytes() const {
+    size_t total = 0;
+    for (const auto& chunk : chunks) {
+        total += chunk.size;
+    }
+    return total;
+}
@@ -0,0 +1,86 @@
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for temporaries that die together (one partition, one
+// superstep). Memory comes in chunks that stay reserved across reset(), so a
+// phase that runs repeatedly stops calling malloc after its first run. Not
+// thread-safe; give each worker its own arena.
+class MonotonicArena {
+public:
+    explicit MonotonicArena(size_t chunk_bytes = 1 << 20) : chunk_bytes(chunk_bytes) {}
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* allocate(size_t bytes, size_t align);
+
+    template <typename T>
+    T* allocate(size_t n) { return static_cast<T*>(allocate(n * sizeof(T), alignof(T))); }
+
+    // Every allocation dies; the chunks are kept for the next round
+    void reset();
+    // Return the chunks to the system
+    void release();
+    size_t reserved_bytes() const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    size_t chunk_bytes;
+    std::vector<Chunk> chunks;
+    size_t current = 0;  // chunk being filled
+    size_t used = 0;     // bytes used in it
+};
+
+// Standard allocator drawing from an arena. deallocate is a no-op, so node
+// containers (maps, sets) built on it cost one bump per node and are freed
+// all at once when the arena resets.
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    MonotonicArena* arena;
+
+    explicit ArenaAllocator(MonotonicArena& arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return arena->allocate<T>(n); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+// One reusable buffer per pool worker. Buffers keep their capacity when
+// cleared, so loops over chunks, partitions or supersteps reuse the memory of
+// the previous round instead of allocating per chunk.
+template <typename T>
+class WorkerScratch {
+public:
+    explicit WorkerScratch(int num_workers = 0) : buffers(num_workers) {}
+
+    int size() const { return static_cast<int>(buffers.size()); }
+    void resize(int num_workers) { buffers.resize(num_workers); }
+    std::vector<T>& operator[](int worker) { return buffers[worker]; }
+    const std::vector<T>& operator[](int worker) const { return buffers[worker]; }
+
+    void clear() {
+        for (auto& buffer : buffers) {
+            buffer.clear();
+        }
+    }
+
+private:
+    std::vector<std::vector<T>> buffers;
+};
+
+#endif // SCRATCH_H
@@ -0,0 +1,206 @@
+#include "superstep.h"
+#include "mpi_utils.h"
+#include "thread_pool.h"
+#include "profile.h"
+#include <algorithm>
+
+// Frontier edges per work-stealing chunk
+static const int SUPERSTEP_GRAIN = 64;
+
+// Frontier edges charged between two polls of the notice exchange
+static const int OVERLAP_BATCH = 4096;
+
+static const int NOTICE_TAG = 1;
+static const int DELTA_TAG = 2;
+
+void init_peel_state(const DistGraph& D, PeelState& state) {
+    state.removed.assign(D.local.num_edges(), 0);
+    state.in_frontier.assign(D.local.num_edges(), 0);
+    state.superstep = 0;
+
+    // Every message travels between two holders of the same arc, and an arc's
+    // holders are the owners and subscribers of its endpoints
+    const DiGraph& G = D.local;
+    vector<char> is_neighbor(D.size, 0);
+    for (int x = 0; x < G.num_vertices; ++x) {
+        if (G.out_degree(x) + G.in_degree(x) == 0) {
+            continue;
+        }
+        is_neighbor[vertex_owner(G.labels[x], D.size)] = 1;
+        for (int i = D.subscriber_offsets[x]; i < D.subscriber_offsets[x + 1]; ++i) {
+            is_neighbor[D.subscribers[i]] = 1;
+        }
+    }
+    // A head pulled in with a ghost's adjacency makes its owner a neighbor here,
+    // but not the other way round; both sides must expect each other's messages
+    vector<char> marked_by(D.size, 0);
+    MPI_Alltoall(is_neighbor.data(), 1, MPI_CHAR, marked_by.data(), 1, MPI_CHAR, MPI_COMM_WORLD);
+    for (int r = 0; r < D.size; ++r) {
+        is_neighbor[r] |= marked_by[r];
+    }
+    state.neighbors.clear();
+    for (int r = 0; r < D.size; ++r) {
+        if (is_neighbor[r] && r != D.rank) {
+            state.neighbors.push_back(r);
+        }
+    }
+}
+
+// Charge the live triangles of frontier[begin, end) once each, from their lowest-id
+// frontier edge. Local edge ids follow the (u, v) order of original ids, so all ranks
+// agree on that edge. Interior triangles (both partners owned here) only need local
+// frontier state; the others need every notice of this superstep.
+static void charge_frontier(const DistGraph& D, EdgeSupports& supports, PeelState& state, const vector<int>& frontier, int begin, int end, bool interior, WorkerScratch<EdgeDelta>& local_deltas) {
+    const DiGraph& G = D.local;
+    const vector<char>& removed = state.removed;
+    const vector<char>& in_frontier = state.in_frontier;
+
+    thread_pool().parallel_for(begin, end, SUPERSTEP_GRAIN, [&](int chunk_begin, int chunk_end, int worker) {
+        auto charge = [&](int f, int cycle_delta, int flow_delta) {
+            if (in_frontier[f]) {
+                return;
+            }
+            if (D.owns_edge(f)) {
+                if (cycle_delta) {
+                    atomic_decrement(supports.cycle[f]);
+                } else {
+                    atomic_decrement(supports.flow[f]);
+                }
+            } else {
+                local_deltas[worker].push_back({G.labels[G.source(f)], G.labels[G.target(f)], cycle_delta, flow_delta});
+            }
+        };
+        for (int i = chunk_begin; i < chunk_end; ++i) {
+            int e = frontier[i];
+            auto selected = [&](int e1, int e2) {
+                if ((D.owns_edge(e1) && D.owns_edge(e2)) != interior) {
+                    return false;
+                }
+                return !((in_frontier[e1] && e1 < e) || (in_frontier[e2] && e2 < e));
+            };
+            for_each_cycle_triangle(G, e, &removed, [&](int e1, int e2) {
+                if (selected(e1, e2)) {
+                    charge(e1, -1, 0);
+                    charge(e2, -1, 0);
+                }
+            });
+            for_each_flow_triangle(G, e, &removed, [&](int e1, int e2) {
+                if (selected(e1, e2)) {
+                    charge(e1, 0, -1);
+                    charge(e2, 0, -1);
+                }
+            });
+        }
+    });
+}
+
+long long peel_superstep(const DistGraph& D, EdgeSupports& supports, PeelState& state, int k_c, int k_f) {
+    PhaseTimer timer("superstep." + to_string(state.superstep));
+    const DiGraph& G = D.local;
+    vector<char>& removed = state.removed;
+    vector<char>& in_frontier = state.in_frontier;
+    SuperstepBuffers& buffers = state.buffers;
+
+    // (1) Frontier: live owned edges that miss either threshold, or whose
+    // trussness bound already rules them out of the (k_c, k_f) subgraph
+    bool bounded = !state.cycle_bound.empty();
+    vector<int>& frontier = buffers.frontier;
+    frontier.clear();
+    for (int e : D.owned_edges) {
+        if (removed[e]) {
+            continue;
+        }
+        if (supports.cycle[e] < k_c || supports.flow[e] < k_f ||
+            (bounded && (state.cycle_bound[e] < k_c || state.flow_bound[e] < k_f))) {
+            frontier.push_back(e);
+        }
+    }
+
+    // The termination count reduces in the background for the whole superstep
+    long long local_count = static_cast<long long>(frontier.size());
+    profiler().count_peeled(local_count);
+    long long global_count = 0;
+    MPI_Request count_request;
+    MPI_Iallreduce(&local_count, &global_count, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD, &count_request);
+
+    // (2) Tell every other holder of a frontier arc that it is being peeled
+    vector<vector<EdgeDelta>>& messages = buffers.messages;
+    messages.resize(D.size);
+    for (int e : frontier) {
+        in_frontier[e] = 1;
+        D.arc_holders(e, buffers.holders);
+        for (int r : buffers.holders) {
+            messages[r].push_back({G.labels[G.source(e)], G.labels[G.target(e)], 0, 0});
+        }
+    }
+    NeighborExchange& notices = buffers.notices;
+    post_messages(notices, state.neighbors, messages, NOTICE_TAG);
+
+    // (3) Charge interior triangles while the notices are in flight, marking
+    // remote frontier arcs between batches as they arrive
+    WorkerScratch<EdgeDelta>& local_deltas = buffers.local_deltas;
+    local_deltas.resize(thread_pool().size());
+    vector<int>& peeled = buffers.peeled;
+    peeled.assign(frontier.begin(), frontier.end());
+    vector<EdgeDelta>& received = buffers.received;
+    received.clear();
+    auto mark_notices = [&]() {
+        for (const auto& notice : received) {
+            int e = local_edge_id(D, notice.u, notice.v);
+            if (e >= 0 && !removed[e] && !in_frontier[e]) {
+                in_frontier[e] = 1;
+                peeled.push_back(e);
+            }
+        }
+        received.clear();
+    };
+    for (int begin = 0; begin < static_cast<int>(frontier.size()); begin += OVERLAP_BATCH) {
+        int end = std::min(begin + OVERLAP_BATCH, static_cast<int>(frontier.size()));
+        charge_frontier(D, supports, state, frontier, begin, end, true, local_deltas);
+        while (poll_messages(notices, received)) {
+            mark_notices();
+        }
+    }
+    while (wait_message(notices, received)) {
+        mark_notices();
+    }
+    finish_messages(notices);
+
+    // (4) Boundary triangles need the full frontier
+    charge_frontier(D, supports, state, frontier, 0, static_cast<int>(frontier.size()), false, local_deltas);
+
+    // (5) Send only the changed supports, merged per edge, to their owners; retire
+    // the peeled arcs while they travel and apply updates in arrival order
+    vector<EdgeDelta>& deltas = buffers.deltas;
+    for (int w = 0; w < local_deltas.size(); ++w) {
+        deltas.insert(deltas.end(), local_deltas[w].begin(), local_deltas[w].end());
+    }
+    local_deltas.clear();
+    prepare_messages(D, deltas, messages);
+    NeighborExchange& updates = buffers.updates;
+    post_messages(updates, state.neighbors, messages, DELTA_TAG);
+
+    for (int e : peeled) {
+        in_frontier[e] = 0;
+        removed[e] = 1;
+        supports.cycle[e] = 0;
+        supports.flow[e] = 0;
+    }
+    while (wait_message(updates, received)) {
+        update_supports(D, supports, received);
+        received.clear();
+    }
+    finish_messages(updates);
+    state.superstep++;
+
+    MPI_Wait(&count_request, MPI_STATUS_IGNORE);
+    return global_count;
+}
+
+void distributed_peel(const DistGraph& D, EdgeSupports& supports, PeelState& state, int k_c, int k_f, const SuperstepHook& after_superstep) {
+    while (peel_superstep(D, supports, state, k_c, k_f) > 0) {
+        if (after_superstep) {
+            after_superstep(state);
+        }
+    }
+}
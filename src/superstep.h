@@ -0,0 +1,48 @@
+#ifndef SUPERSTEP_H
+#define SUPERSTEP_H
+
+#include <functional>
+#include <vector>
+#include "graph.h"
+#include "mpi_utils.h"
+#include "scratch.h"
+
+// Temporaries of one superstep. They live in the peel state so that their
+// capacity carries over and later supersteps do not allocate.
+struct SuperstepBuffers {
+    std::vector<int> frontier, peeled, holders;
+    std::vector<EdgeDelta> received, deltas;
+    std::vector<std::vector<EdgeDelta>> messages;  // per destination rank
+    WorkerScratch<EdgeDelta> local_deltas;         // per pool worker
+    NeighborExchange notices, updates;
+};
+
+// Per-rank state of the distributed peel, kept between supersteps
+struct PeelState {
+    std::vector<char> removed;     // per local arc: peeled on some rank
+    std::vector<char> in_frontier; // per local arc: being peeled this superstep
+    std::vector<int> neighbors;    // ranks sharing at least one arc with this one
+    std::vector<int> cycle_bound;  // optional per local arc: trussness upper bounds; an
+    std::vector<int> flow_bound;   // owned edge bounded below a threshold is peeled at once
+    int superstep = 0;
+    SuperstepBuffers buffers;
+};
+
+void init_peel_state(const DistGraph& D, PeelState& state);
+
+// One superstep of the (k_c, k_f) peel on the owner layout: every rank peels
+// its owned edges that miss a threshold, notifies the other holders of those
+// arcs, charges each dead triangle once, and sends the aggregated support
+// deltas to the partner edges' owners. All communication is nonblocking:
+// triangles whose partners are owned locally are charged while the notices
+// are in flight, updates are applied in arrival order, and the global peeled
+// count (the return value) comes from a nonblocking allreduce.
+long long peel_superstep(const DistGraph& D, EdgeSupports& supports, PeelState& state, int k_c, int k_f);
+
+// Called on every rank between supersteps, once all updates of the step are applied
+typedef std::function<void(const PeelState&)> SuperstepHook;
+
+// Run supersteps until no rank peels anything
+void distributed_peel(const DistGraph& D, EdgeSupports& supports, PeelState& state, int k_c, int k_f, const SuperstepHook& after_superstep = nullptr);
+
+#endif // SUPERSTEP_H
@@ -0,0 +1,122 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int num_threads) : num_threads(std::max(1, num_threads)) {
+    for (int i = 0; i < this->num_threads; ++i) {
+        queues.emplace_back(new WorkQueue);
+    }
+    for (int i = 1; i < this->num_threads; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(job_lock);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallel_for(int begin, int end, int grain, const RangeBody& body) {
+    if (end <= begin) {
+        return;
+    }
+    grain = std::max(1, grain);
+    if (num_threads == 1 || end - begin <= grain) {
+        body(begin, end, 0);
+        return;
+    }
+
+    // Deal chunks round-robin so every worker starts with local work
+    int q = 0;
+    for (int lo = begin; lo < end; lo += grain) {
+        std::lock_guard<std::mutex> guard(queues[q]->lock);
+        queues[q]->chunks.push_back({lo, std::min(end, lo + grain)});
+        q = (q + 1) % num_threads;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(job_lock);
+        job_body = &body;
+        job_generation++;
+        busy_workers = num_threads - 1;
+    }
+    job_ready.notify_all();
+
+    run_chunks(0);
+
+    std::unique_lock<std::mutex> lock(job_lock);
+    job_done.wait(lock, [this] { return busy_workers == 0; });
+    job_body = nullptr;
+}
+
+void ThreadPool::worker_loop(int worker_id) {
+    unsigned long seen_generation = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(job_lock);
+            job_ready.wait(lock, [&] { return stopping || job_generation != seen_generation; });
+            if (stopping) {
+                return;
+            }
+            seen_generation = job_generation;
+        }
+
+        run_chunks(worker_id);
+
+        std::lock_guard<std::mutex> guard(job_lock);
+        if (--busy_workers == 0) {
+            job_done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::run_chunks(int worker_id) {
+    std::pair<int, int> chunk;
+    while (pop_chunk(worker_id, chunk)) {
+        (*job_body)(chunk.first, chunk.second, worker_id);
+    }
+}
+
+bool ThreadPool::pop_chunk(int worker_id, std::pair<int, int>& chunk) {
+    // Own deque from the back, then steal from the front of the others
+    {
+        WorkQueue& own = *queues[worker_id];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.back();
+            own.chunks.pop_back();
+            return true;
+        }
+    }
+    for (int k = 1; k < num_threads; ++k) {
+        WorkQueue& victim = *queues[(worker_id + k) % num_threads];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.front();
+            victim.chunks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::unique_ptr<ThreadPool> global_pool;
+
+void init_thread_pool(int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    global_pool.reset(new ThreadPool(num_threads));
+}
+
+ThreadPool& thread_pool() {
+    if (!global_pool) {
+        global_pool.reset(new ThreadPool(1));
+    }
+    return *global_pool;
+}
@@ -0,0 +1,76 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of workers used for intra-rank parallelism. parallel_for
+// splits a range into chunks, deals them round-robin onto per-worker deques,
+// and lets idle workers steal from the front of other deques. The calling
+// thread participates as worker 0.
+class ThreadPool {
+public:
+    // body(chunk_begin, chunk_end, worker_id)
+    typedef std::function<void(int, int, int)> RangeBody;
+
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    int size() const { return num_threads; }
+    void parallel_for(int begin, int end, int grain, const RangeBody& body);
+
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::pair<int, int>> chunks;
+    };
+
+    void worker_loop(int worker_id);
+    void run_chunks(int worker_id);
+    bool pop_chunk(int worker_id, std::pair<int, int>& chunk);
+
+    int num_threads;
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    std::mutex job_lock;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    const RangeBody* job_body = nullptr;
+    unsigned long job_generation = 0;
+    int busy_workers = 0;
+    bool stopping = false;
+};
+
+// Process-wide pool shared by the graph, partitioner and peeler modules.
+// init_thread_pool(0) uses all hardware threads; the default is one thread.
+void init_thread_pool(int num_threads);
+ThreadPool& thread_pool();
+
+// Relaxed atomic decrement for supports updated concurrently by peeling workers
+inline int atomic_decrement(int& value) {
+    return __atomic_sub_fetch(&value, 1, __ATOMIC_RELAXED);
+}
+
+// Relaxed atomic add for supports credited concurrently by counting workers
+inline void atomic_add(int& value, int delta) {
+    __atomic_fetch_add(&value, delta, __ATOMIC_RELAXED);
+}
+
+// Atomic decrement that never goes below floor; returns whether value changed
+inline bool atomic_decrement_above(int& value, int floor) {
+    int current = __atomic_load_n(&value, __ATOMIC_RELAXED);
+    while (current > floor) {
+        if (__atomic_compare_exchange_n(&value, &current, current - 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // THREAD_POOL_H
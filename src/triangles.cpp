@@ -0,0 +1,337 @@
+#include "triangles.h"
+#include "thread_pool.h"
+#include "scratch.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace std;
+
+// Vertices per work-stealing chunk when building and enumerating
+static const int TRIANGLE_GRAIN = 64;
+
+// The six possible arcs of a triangle (x, y, z), in mask bit order:
+// x -> y, y -> x, x -> z, z -> x, y -> z, z -> y
+static const int ARC_TAIL[6] = {0, 1, 0, 2, 1, 2};
+static const int ARC_HEAD[6] = {1, 0, 2, 0, 2, 1};
+
+// Cycle and flow triangles each present arc belongs to, for every mask of present arcs
+struct TriangleCredit {
+    unsigned char cycle[6];
+    unsigned char flow[6];
+};
+
+static vector<TriangleCredit> build_credit_table() {
+    vector<TriangleCredit> table(64);
+    for (int mask = 0; mask < 64; ++mask) {
+        bool has[3][3] = {};
+        for (int k = 0; k < 6; ++k) {
+            has[ARC_TAIL[k]][ARC_HEAD[k]] = (mask >> k) & 1;
+        }
+        for (int k = 0; k < 6; ++k) {
+            int u = ARC_TAIL[k], v = ARC_HEAD[k], w = 3 - u - v;
+            bool present = has[u][v];
+            // Same cases as count_edge_triangles for edge u -> v and third vertex w
+            table[mask].cycle[k] = present && has[v][w] && has[w][u];
+            table[mask].flow[k] = present * ((has[u][w] && has[w][v]) + (has[w][u] && has[w][v]) + (has[u][w] && has[v][w]));
+        }
+    }
+    return table;
+}
+
+static const vector<TriangleCredit> TRIANGLE_CREDIT = build_credit_table();
+
+// Walk the merged out- and in-lists of x: f(neighbor, out arc id, in arc id)
+// once per neighbor joined by a live arc, with -1 for a missing or removed one
+template <typename F>
+static void for_each_neighbor(const DiGraph& G, int x, const vector<char>* removed, F f) {
+    int i = G.out_offsets[x], i_end = G.out_offsets[x + 1];
+    int j = G.in_offsets[x], j_end = G.in_offsets[x + 1];
+    while (i < i_end || j < j_end) {
+        int a = i < i_end ? G.out_targets[i] : G.num_vertices;
+        int b = j < j_end ? G.in_sources[j] : G.num_vertices;
+        int out_arc = a <= b ? i++ : -1;
+        int in_arc = b <= a ? G.in_edge_ids[j++] : -1;
+        if (removed && out_arc >= 0 && (*removed)[out_arc]) {
+            out_arc = -1;
+        }
+        if (removed && in_arc >= 0 && (*removed)[in_arc]) {
+            in_arc = -1;
+        }
+        if (out_arc >= 0 || in_arc >= 0) {
+            f(min(a, b), out_arc, in_arc);
+        }
+    }
+}
+
+void build_oriented_graph(const DiGraph& G, const vector<char>* owned, const vector<char>* removed, OrientedGraph& O) {
+    int n = G.num_vertices;
+    ThreadPool& pool = thread_pool();
+
+    vector<int> degree(n);
+    pool.parallel_for(0, n, TRIANGLE_GRAIN, [&](int begin, int end, int) {
+        for (int x = begin; x < end; ++x) {
+            int d = 0;
+            for_each_neighbor(G, x, removed, [&d](int, int, int) { d++; });
+            degree[x] = d;
+        }
+    });
+    auto ranks_below = [&degree](int x, int y) {
+        return degree[x] != degree[y] ? degree[x] < degree[y] : x < y;
+    };
+
+    // Keys: owned vertices first, each group in rank order so that the lists of
+    // low-degree vertices sit together and hubs share the top of the key range
+    vector<int> order(n), key(n);
+    for (int x = 0; x < n; ++x) {
+        order[x] = x;
+    }
+    auto is_owned = [owned](int x) { return !owned || (*owned)[x]; };
+    sort(order.begin(), order.end(), [&](int x, int y) {
+        return is_owned(x) != is_owned(y) ? is_owned(x) : ranks_below(x, y);
+    });
+    O.num_vertices = n;
+    O.num_owned = 0;
+    for (int k = 0; k < n; ++k) {
+        key[order[k]] = k;
+        O.num_owned += is_owned(order[k]);
+    }
+    vector<int>().swap(order);
+
+    O.offsets.assign(n + 1, 0);
+    pool.parallel_for(0, n, TRIANGLE_GRAIN, [&](int begin, int end, int) {
+        for (int x = begin; x < end; ++x) {
+            int count = 0;
+            for_each_neighbor(G, x, removed, [&](int y, int, int) { count += ranks_below(x, y); });
+            O.offsets[key[x] + 1] = count;
+        }
+    });
+    for (int k = 0; k < n; ++k) {
+        O.offsets[k + 1] += O.offsets[k];
+    }
+
+    int m = O.offsets[n];
+    O.heads.resize(m);
+    O.forward_arcs.resize(m);
+    O.backward_arcs.resize(m);
+    O.owned_end.resize(n);
+    WorkerScratch<tuple<int, int, int>> scratch(pool.size());
+    pool.parallel_for(0, n, TRIANGLE_GRAIN, [&](int begin, int end, int worker) {
+        vector<tuple<int, int, int>>& list = scratch[worker];
+        for (int x = begin; x < end; ++x) {
+            list.clear();
+            for_each_neighbor(G, x, removed, [&](int y, int out_arc, int in_arc) {
+                if (ranks_below(x, y)) {
+                    list.emplace_back(key[y], out_arc, in_arc);
+                }
+            });
+            sort(list.begin(), list.end());
+
+            int k = key[x], pos = O.offsets[k];
+            O.owned_end[k] = pos;
+            for (const auto& entry : list) {
+                O.heads[pos] = get<0>(entry);
+                O.forward_arcs[pos] = get<1>(entry);
+                O.backward_arcs[pos] = get<2>(entry);
+                if (get<0>(entry) < O.num_owned) {
+                    O.owned_end[k] = pos + 1;
+                }
+                pos++;
+            }
+        }
+    });
+}
+
+// f(i, p, q, mask) for every triangle (x, y, z) listed from x: i and p are the
+// positions of y and z in the list of x, q that of z in the list of y, and
+// mask has the present arcs. slot holds position + 1 of each head of x.
+template <typename F>
+static void triangles_from(const OrientedGraph& O, int x, const vector<int>& slot, F f) {
+    for (int i = O.offsets[x]; i < O.offsets[x + 1]; ++i) {
+        // Without an owned vertex among x and y only an owned z can make a
+        // triangle with an owned edge, and those heads come first
+        int y = O.heads[i];
+        int q_end = (x < O.num_owned || y < O.num_owned) ? O.offsets[y + 1] : O.owned_end[y];
+        for (int q = O.offsets[y]; q < q_end; ++q) {
+            int p = slot[O.heads[q]] - 1;
+            if (p < 0) {
+                continue;
+            }
+            int mask = (O.forward_arcs[i] >= 0) | (O.backward_arcs[i] >= 0) << 1
+                     | (O.forward_arcs[p] >= 0) << 2 | (O.backward_arcs[p] >= 0) << 3
+                     | (O.forward_arcs[q] >= 0) << 4 | (O.backward_arcs[q] >= 0) << 5;
+            f(i, p, q, mask);
+        }
+    }
+}
+
+static void fill_slots(const OrientedGraph& O, int x, vector<int>& slot, bool clear) {
+    for (int p = O.offsets[x]; p < O.offsets[x + 1]; ++p) {
+        slot[O.heads[p]] = clear ? 0 : p + 1;
+    }
+}
+
+// Add a credit to arc e if its tail is owned
+static inline void credit_arc(int e, int tail, int num_owned, int amount, vector<int>& support) {
+    if (amount && tail < num_owned) {
+        atomic_add(support[e], amount);
+    }
+}
+
+void count_triangle_supports(const OrientedGraph& O, vector<int>& cycle, vector<int>& flow) {
+    ThreadPool& pool = thread_pool();
+    // Per worker: head slots of the current x, and the credits of the arcs
+    // between x and its heads, which are gathered locally and added once per x
+    WorkerScratch<int> slots(pool.size());
+    WorkerScratch<int> pending(pool.size());
+
+    pool.parallel_for(0, O.num_vertices, TRIANGLE_GRAIN, [&](int begin, int end, int worker) {
+        vector<int>& slot = slots[worker];
+        vector<int>& held = pending[worker];
+        if (slot.empty()) {
+            slot.assign(O.num_vertices, 0);
+        }
+        for (int x = begin; x < end; ++x) {
+            int base = O.offsets[x], length = O.offsets[x + 1] - base;
+            fill_slots(O, x, slot, false);
+            // Four counters per head: x -> head cycle, flow; head -> x cycle, flow
+            held.assign(4 * length, 0);
+
+            triangles_from(O, x, slot, [&](int i, int p, int q, int mask) {
+                const TriangleCredit& credit = TRIANGLE_CREDIT[mask];
+                int* at_i = &held[4 * (i - base)];
+                int* at_p = &held[4 * (p - base)];
+                at_i[0] += credit.cycle[0];
+                at_i[1] += credit.flow[0];
+                at_i[2] += credit.cycle[1];
+                at_i[3] += credit.flow[1];
+                at_p[0] += credit.cycle[2];
+                at_p[1] += credit.flow[2];
+                at_p[2] += credit.cycle[3];
+                at_p[3] += credit.flow[3];
+                int y = O.heads[i], z = O.heads[q];
+                credit_arc(O.forward_arcs[q], y, O.num_owned, credit.cycle[4], cycle);
+                credit_arc(O.forward_arcs[q], y, O.num_owned, credit.flow[4], flow);
+                credit_arc(O.backward_arcs[q], z, O.num_owned, credit.cycle[5], cycle);
+                credit_arc(O.backward_arcs[q], z, O.num_owned, credit.flow[5], flow);
+            });
+
+            for (int p = base; p < base + length; ++p) {
+                const int* at_p = &held[4 * (p - base)];
+                credit_arc(O.forward_arcs[p], x, O.num_owned, at_p[0], cycle);
+                credit_arc(O.forward_arcs[p], x, O.num_owned, at_p[1], flow);
+                credit_arc(O.backward_arcs[p], O.heads[p], O.num_owned, at_p[2], cycle);
+                credit_arc(O.backward_arcs[p], O.heads[p], O.num_owned, at_p[3], flow);
+            }
+            fill_slots(O, x, slot, true);
+        }
+    });
+}
+
+void build_triangle_index(const DiGraph& G, const vector<char>* removed, long long budget_bytes, TriangleIndex& index) {
+    int m = G.num_edges();
+    OrientedGraph O;
+    build_oriented_graph(G, nullptr, removed, O);
+    vector<int> cycle(m, 0), flow(m, 0), all(m);
+    count_triangle_supports(O, cycle, flow);
+    for (int e = 0; e < m; ++e) {
+        all[e] = e;
+    }
+    index_triangles(O, m, all, cycle, flow, budget_bytes, index);
+}
+
+void index_triangles(const OrientedGraph& O, int m, const vector<int>& edges, const vector<int>& cycle, const vector<int>& flow,
+                     long long budget_bytes, TriangleIndex& index) {
+    index = TriangleIndex();
+    index.indexed.assign(m, 0);
+
+    // Offsets cost 16 bytes per edge and every listed triangle 8
+    long long budget = budget_bytes - 16LL * (m + 1);
+    if (budget <= 0) {
+        return;
+    }
+
+    // Longest list length at which every edge up to it still fits
+    vector<int> lengths;
+    lengths.reserve(edges.size());
+    for (int e : edges) {
+        lengths.push_back(cycle[e] + flow[e]);
+    }
+    sort(lengths.begin(), lengths.end());
+    int cap = -1;
+    long long used = 0;
+    int n = static_cast<int>(lengths.size());
+    for (int i = 0; i < n; ) {
+        int j = i;
+        long long group = 0;
+        while (j < n && lengths[j] == lengths[i]) {
+            group += 8LL * lengths[j++];
+        }
+        if (used + group > budget) {
+            break;
+        }
+        used += group;
+        cap = lengths[i];
+        i = j;
+    }
+    vector<int>().swap(lengths);
+    for (int e : edges) {
+        index.indexed[e] = cycle[e] + flow[e] <= cap;
+    }
+
+    index.cycle_offsets.assign(m + 1, 0);
+    index.flow_offsets.assign(m + 1, 0);
+    for (int e = 0; e < m; ++e) {
+        index.cycle_offsets[e + 1] = index.cycle_offsets[e] + (index.indexed[e] ? cycle[e] : 0);
+        index.flow_offsets[e + 1] = index.flow_offsets[e] + (index.indexed[e] ? flow[e] : 0);
+    }
+    index.cycle_partners.resize(2 * index.cycle_offsets[m]);
+    index.flow_partners.resize(2 * index.flow_offsets[m]);
+
+    // Each triangle appends itself to the lists of its indexed arcs
+    vector<long long> cycle_cursor(index.cycle_offsets.begin(), index.cycle_offsets.end() - 1);
+    vector<long long> flow_cursor(index.flow_offsets.begin(), index.flow_offsets.end() - 1);
+    auto append = [](vector<long long>& cursor, vector<int>& partners, int e, int e1, int e2) {
+        long long at = __atomic_fetch_add(&cursor[e], 1, __ATOMIC_RELAXED);
+        partners[2 * at] = e1;
+        partners[2 * at + 1] = e2;
+    };
+
+    ThreadPool& pool = thread_pool();
+    WorkerScratch<int> slots(pool.size());
+    pool.parallel_for(0, O.num_vertices, TRIANGLE_GRAIN, [&](int begin, int end, int worker) {
+        vector<int>& slot = slots[worker];
+        if (slot.empty()) {
+            slot.assign(O.num_vertices, 0);
+        }
+        for (int x = begin; x < end; ++x) {
+            fill_slots(O, x, slot, false);
+            triangles_from(O, x, slot, [&](int i, int p, int q, int) {
+                // Arc ids between the triangle's vertices x, y, z (-1 if absent)
+                int id[3][3] = {{-1, O.forward_arcs[i], O.forward_arcs[p]},
+                                {O.backward_arcs[i], -1, O.forward_arcs[q]},
+                                {O.backward_arcs[p], O.backward_arcs[q], -1}};
+                for (int k = 0; k < 6; ++k) {
+                    int u = ARC_TAIL[k], v = ARC_HEAD[k], w = 3 - u - v;
+                    int e = id[u][v];
+                    if (e < 0 || !index.indexed[e]) {
+                        continue;
+                    }
+                    // Partners as for_each_cycle_triangle and for_each_flow_triangle report them
+                    if (id[v][w] >= 0 && id[w][u] >= 0) {
+                        append(cycle_cursor, index.cycle_partners, e, id[v][w], id[w][u]);
+                    }
+                    if (id[u][w] >= 0 && id[w][v] >= 0) {
+                        append(flow_cursor, index.flow_partners, e, id[u][w], id[w][v]);
+                    }
+                    if (id[w][u] >= 0 && id[w][v] >= 0) {
+                        append(flow_cursor, index.flow_partners, e, id[w][u], id[w][v]);
+                    }
+                    if (id[u][w] >= 0 && id[v][w] >= 0) {
+                        append(flow_cursor, index.flow_partners, e, id[u][w], id[v][w]);
+                    }
+                }
+            });
+            fill_slots(O, x, slot, true);
+        }
+    });
+}
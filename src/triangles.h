@@ -0,0 +1,101 @@
+#ifndef TRIANGLES_H
+#define TRIANGLES_H
+
+#include <vector>
+#include "digraph.h"
+
+// Underlying undirected graph of a DiGraph, oriented from lower to higher
+// degree rank (undirected degree, then dense id), so every triangle is found
+// exactly once from its lowest-ranked vertex and no vertex has more than
+// O(sqrt(m)) higher-ranked neighbors.
+//
+// Vertices are renumbered to keys with the owned ones first; a list entry
+// keeps both arc ids of its vertex pair (-1 where an arc is missing), so
+// reciprocal arcs share one undirected pair.
+struct OrientedGraph {
+    int num_vertices = 0;
+    int num_owned = 0;               // keys below this belong to owned vertices
+    std::vector<int> offsets;        // per key, CSR into the lists below
+    std::vector<int> owned_end;      // per key, end of the owned heads in its list
+    std::vector<int> heads;          // higher-ranked neighbor keys, sorted
+    std::vector<int> forward_arcs;   // edge id of key -> head, or -1
+    std::vector<int> backward_arcs;  // edge id of head -> key, or -1
+};
+
+// owned: per dense vertex, nonzero if the vertex is owned; nullptr owns all.
+// Edges marked in `removed` (may be nullptr) are left out.
+void build_oriented_graph(const DiGraph& G, const std::vector<char>* owned, const std::vector<char>* removed, OrientedGraph& O);
+
+// Cycle and flow supports of the owned edges (owned tail) from one pass over
+// all triangles; every triangle is classified from the arcs present among its
+// three vertices and credits all of them at once. Credits are added to cycle
+// and flow, which the caller zeroes first.
+void count_triangle_supports(const OrientedGraph& O, std::vector<int>& cycle, std::vector<int>& flow);
+
+// Per-edge lists of the triangles of every edge, so that peeling can reach the
+// partners of a removed edge without intersecting neighborhoods again. A
+// triangle is kept as its two partner edge ids (the third vertex is implied),
+// in one arena per triangle type. A triangle is dead once a partner is marked
+// removed.
+//
+// Edges whose lists do not fit the memory budget, largest lists first, are
+// not indexed and fall back to enumerating from the adjacency.
+struct TriangleIndex {
+    std::vector<char> indexed;             // per edge
+    std::vector<long long> cycle_offsets;  // per edge, CSR into cycle_partners (in pairs)
+    std::vector<long long> flow_offsets;   // per edge, CSR into flow_partners (in pairs)
+    std::vector<int> cycle_partners;       // e1, e2 of each cycle triangle
+    std::vector<int> flow_partners;        // e1, e2 of each flow triangle
+
+    template <typename F>
+    static void visit(const std::vector<long long>& offsets, const std::vector<int>& partners, int e,
+                      const std::vector<char>* removed, F& f) {
+        for (long long k = 2 * offsets[e]; k < 2 * offsets[e + 1]; k += 2) {
+            int e1 = partners[k], e2 = partners[k + 1];
+            if (!removed || (!(*removed)[e1] && !(*removed)[e2])) {
+                f(e1, e2);
+            }
+        }
+    }
+};
+
+// Index the live triangles of G (edges marked in `removed` are left out)
+// within budget_bytes, counting the per-edge offsets. No edge is indexed if
+// even those do not fit.
+void build_triangle_index(const DiGraph& G, const std::vector<char>* removed, long long budget_bytes, TriangleIndex& index);
+
+// Index the triangles of `edges` (G has m edges) from an oriented graph whose
+// per-edge counts are already known, such as the supports counted over the same
+// O, so only the pass that fills the lists remains
+void index_triangles(const OrientedGraph& O, int m, const std::vector<int>& edges, const std::vector<int>& cycle,
+                     const std::vector<int>& flow, long long budget_bytes, TriangleIndex& index);
+
+// Drop-in replacements for CycleTriangles and FlowTriangles that read the
+// index where it has the edge; a null index always enumerates
+struct IndexedCycleTriangles {
+    const TriangleIndex* index;
+
+    template <typename F>
+    void operator()(const DiGraph& G, int e, const std::vector<char>* removed, F f) const {
+        if (index && index->indexed[e]) {
+            TriangleIndex::visit(index->cycle_offsets, index->cycle_partners, e, removed, f);
+        } else {
+            for_each_cycle_triangle(G, e, removed, f);
+        }
+    }
+};
+
+struct IndexedFlowTriangles {
+    const TriangleIndex* index;
+
+    template <typename F>
+    void operator()(const DiGraph& G, int e, const std::vector<char>* removed, F f) const {
+        if (index && index->indexed[e]) {
+            TriangleIndex::visit(index->flow_offsets, index->flow_partners, e, removed, f);
+        } else {
+            for_each_flow_triangle(G, e, removed, f);
+        }
+    }
+};
+
+#endif // TRIANGLES_H
@@ -0,0 +1,100 @@
+#include "truss_bounds.h"
+#include "mpi_utils.h"
+#include "thread_pool.h"
+#include "triangles.h"
+#include "scratch.h"
+#include <mpi.h>
+#include <climits>
+
+// Owned edges per work-stealing chunk for h-index rounds
+static const int BOUND_GRAIN = 256;
+
+// Send the current values of the given owned arcs to their other holders. The
+// EdgeDelta fields carry values here, not differences. Messages are built in
+// the arena, which the caller resets once they are sent.
+template <typename EdgeList>
+static void share_values(const DistGraph& D, const EdgeList& changed, vector<int>& k_c, vector<int>& k_f, MonotonicArena& arena) {
+    typedef vector<EdgeDelta, ArenaAllocator<EdgeDelta>> DeltaList;
+    const DiGraph& G = D.local;
+    vector<DeltaList> messages(D.size, DeltaList(ArenaAllocator<EdgeDelta>(arena)));
+    vector<int> holders;
+    for (int e : changed) {
+        D.arc_holders(e, holders);
+        for (int r : holders) {
+            messages[r].push_back({G.labels[G.source(e)], G.labels[G.target(e)], k_c[e], k_f[e]});
+        }
+    }
+    for (const auto& value : mpi_exchange_messages(messages)) {
+        int e = local_edge_id(D, value.u, value.v);
+        if (e >= 0) {
+            k_c[e] = value.cycle_delta;
+            k_f[e] = value.flow_delta;
+        }
+    }
+}
+
+// Synchronous h-index rounds over the owned edges, from values every holder
+// already has. Stops after `rounds` rounds or once a round changes nothing.
+// Triangles of indexed edges are read from the index.
+static int h_index_rounds(const DistGraph& D, int rounds, const TriangleIndex* index, vector<int>& k_c, vector<int>& k_f, MonotonicArena& arena) {
+    const DiGraph& G = D.local;
+    const vector<int>& owned = D.owned_edges;
+    int n = static_cast<int>(owned.size());
+
+    IndexedCycleTriangles cycle_triangles = {index};
+    IndexedFlowTriangles flow_triangles = {index};
+    ThreadPool& pool = thread_pool();
+    vector<int> next_c(n), next_f(n);
+    vector<vector<int>> scratch(pool.size());
+    int round = 0;
+    while (round < rounds) {
+        // Jacobi step: every owner reads the values of the previous round
+        pool.parallel_for(0, n, BOUND_GRAIN, [&](int begin, int end, int worker) {
+            vector<int>& count = scratch[worker];
+            for (int i = begin; i < end; ++i) {
+                int e = owned[i];
+                next_c[i] = triangle_h_index(G, e, nullptr, k_c, k_c[e], cycle_triangles, count);
+                next_f[i] = triangle_h_index(G, e, nullptr, k_f, k_f[e], flow_triangles, count);
+            }
+        });
+        round++;
+
+        // The previous round's lists are dead; their chunks are reused
+        arena.reset();
+        vector<int, ArenaAllocator<int>> changed{ArenaAllocator<int>(arena)};
+        for (int i = 0; i < n; ++i) {
+            int e = owned[i];
+            if (next_c[i] != k_c[e] || next_f[i] != k_f[e]) {
+                k_c[e] = next_c[i];
+                k_f[e] = next_f[i];
+                changed.push_back(e);
+            }
+        }
+        long long local_changed = static_cast<long long>(changed.size()), global_changed = 0;
+        MPI_Allreduce(&local_changed, &global_changed, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        if (global_changed == 0) {
+            break;
+        }
+        share_values(D, changed, k_c, k_f, arena);
+    }
+    return round;
+}
+
+int trussness_upper_bounds(const DistGraph& D, const EdgeSupports& supports, int rounds, vector<int>& k_c, vector<int>& k_f, const TriangleIndex* index) {
+    // An edge's trussness never exceeds its support
+    k_c.assign(D.local.num_edges(), 0);
+    k_f.assign(D.local.num_edges(), 0);
+    for (int e : D.owned_edges) {
+        k_c[e] = supports.cycle[e];
+        k_f[e] = supports.flow[e];
+    }
+    MonotonicArena arena;
+    share_values(D, D.owned_edges, k_c, k_f, arena);
+    return h_index_rounds(D, rounds, index, k_c, k_f, arena);
+}
+
+int exact_trussness(const DistGraph& D, vector<int>& k_c, vector<int>& k_f, const TriangleIndex* index) {
+    MonotonicArena arena;
+    share_values(D, D.owned_edges, k_c, k_f, arena);
+    return h_index_rounds(D, INT_MAX, index, k_c, k_f, arena);
+}
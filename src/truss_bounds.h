@@ -0,0 +1,25 @@
+#ifndef TRUSS_BOUNDS_H
+#define TRUSS_BOUNDS_H
+
+#include <vector>
+#include "graph.h"
+#include "dist_graph.h"
+#include "triangles.h"
+
+// Upper bounds on the cycle and flow trussness of every local arc, without a
+// full decomposition. Bounds start at the supports of owned edges (which need
+// compute_supports first) and tighten by synchronous h-index rounds: each
+// owner replaces its value by the h-index of min(partner values) over the
+// edge's triangles, then sends changed values to the other holders of the
+// arc. Every round keeps a valid bound; if a round changes nothing the bounds
+// are the exact trussness and the loop stops early. k_c and k_f are indexed
+// by local edge id. Triangles of edges in the index (from compute_supports)
+// are read from it. Returns the number of rounds run.
+int trussness_upper_bounds(const DistGraph& D, const EdgeSupports& supports, int rounds, std::vector<int>& k_c, std::vector<int>& k_f, const TriangleIndex* index = nullptr);
+
+// Exact trussness from pointwise upper bounds: k_c and k_f hold bounds on the
+// owned edges (the other holders get them from the owners), and h-index rounds
+// run until no value changes. Returns the number of rounds run.
+int exact_trussness(const DistGraph& D, std::vector<int>& k_c, std::vector<int>& k_f, const TriangleIndex* index = nullptr);
+
+#endif // TRUSS_BOUNDS_H
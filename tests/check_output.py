@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""End-to-end check of the (k_c, k_f) output of ./main against brute force.
+
+Runs the full decomposition on data/graph.e, a small chain and small generated
+graphs over 1, 2, ... ranks (up to --max-ranks) with both partitioners, and
+compares every output line with a decomposition computed here by definition:
+the trussness of an edge is the largest k such that it survives when edges
+with fewer than k triangles of that type are dropped until none is left.
+The same graphs are queried with --query, whose output must be the edges left
+when edges below either threshold are dropped, with their supports among them.
+
+    python3 tests/check_output.py --main src/main --max-ranks 4
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+from collections import defaultdict
+
+GRAPHS = [
+    ["--input", os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "data", "graph.e")],
+    ["--generate", "rmat", "--scale", "8", "--edge-factor", "8", "--reciprocity", "0.3"],
+    ["--generate", "er", "--scale", "8", "--edge-factor", "6", "--reciprocity", "0.4"],
+]
+
+QUERIES = [(0, 0), (1, 2), (2, 4)]
+
+
+def supports(edges, kind):
+    out_nbrs = defaultdict(set)
+    in_nbrs = defaultdict(set)
+    for u, v in edges:
+        out_nbrs[u].add(v)
+        in_nbrs[v].add(u)
+    counts = {}
+    for u, v in edges:
+        if kind == "cycle":
+            counts[(u, v)] = len(out_nbrs[v] & in_nbrs[u])
+        else:
+            counts[(u, v)] = (len(out_nbrs[u] & in_nbrs[v]) + len(in_nbrs[u] & in_nbrs[v]) +
+                              len(out_nbrs[u] & out_nbrs[v]))
+    return counts
+
+
+def trussness(edges, kind):
+    result = dict.fromkeys(edges, 0)
+    live = set(edges)
+    k = 0
+    while live:
+        k += 1
+        while True:
+            counts = supports(live, kind)
+            dropped = {e for e in live if counts[e] < k}
+            if not dropped:
+                break
+            live -= dropped
+        for e in live:
+            result[e] = k
+    return result
+
+
+def truss_query(edges, k_c, k_f):
+    live = set(edges)
+    while True:
+        cycle = supports(live, "cycle")
+        flow = supports(live, "flow")
+        dropped = {e for e in live if cycle[e] < k_c or flow[e] < k_f}
+        if not dropped:
+            return {e: (cycle[e], flow[e]) for e in live}
+        live -= dropped
+
+
+def run(args, ranks, graph, partitioner):
+    with tempfile.TemporaryDirectory() as tmp:
+        output = os.path.join(tmp, "result")
+        command = ["mpirun", "-np", str(ranks)] + args.mpirun_args.split() + [
+            args.main, "--partitioner", partitioner, "--threads", str(args.threads), "--output", output] + graph
+        try:
+            result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True,
+                                    timeout=args.timeout)
+        except subprocess.TimeoutExpired:
+            sys.exit("run timed out: " + " ".join(command))
+        if result.returncode != 0:
+            sys.exit("run failed: " + " ".join(command) + "\n" + result.stderr)
+        records = {}
+        with open(output) as f:
+            for line in f:
+                u, v, k_c, k_f = (int(x) for x in line.split())
+                records[(u, v)] = (k_c, k_f)
+        return records
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--main", default="src/main", help="path to the compiled executable")
+    parser.add_argument("--max-ranks", type=int, default=4)
+    parser.add_argument("--threads", type=int, default=1, help="threads per rank")
+    parser.add_argument("--mpirun-args", default="--oversubscribe", help="extra mpirun arguments")
+    parser.add_argument("--timeout", type=int, default=120, help="seconds before a run counts as hung")
+    args = parser.parse_args()
+
+    failures = 0
+
+    def compare(what, records, expected):
+        wrong = [e for e in expected if records.get(e) != expected[e]]
+        if len(records) != len(expected) or wrong:
+            print("FAILED: %s: %d of %d edges differ (e.g. %s)" % (what, len(wrong), len(expected), wrong[:3]))
+            return 1
+        return 0
+
+    with tempfile.TemporaryDirectory() as tmp:
+        # A head-only vertex reached through a ghost's adjacency, whose owner
+        # shares no arc with the rank holding it
+        chain = os.path.join(tmp, "chain.e")
+        with open(chain, "w") as f:
+            f.write("7 10\n10 1\n")
+        for graph in GRAPHS + [["--input", chain]]:
+            # The single-rank output names every edge of the graph
+            edges = list(run(args, 1, graph, "stratified"))
+            cycle = trussness(edges, "cycle")
+            flow = trussness(edges, "flow")
+            expected = {e: (cycle[e], flow[e]) for e in edges}
+            for ranks in range(1, args.max_ranks + 1):
+                for partitioner in ["stratified", "type-aware"]:
+                    records = run(args, ranks, graph, partitioner)
+                    failures += compare("%s, %d ranks, %s partitioner" % (" ".join(graph), ranks, partitioner), records, expected)
+                for k_c, k_f in QUERIES:
+                    query = graph + ["--query", str(k_c), str(k_f)]
+                    records = run(args, ranks, query, "stratified")
+                    failures += compare("%s, %d ranks" % (" ".join(query), ranks), records, truss_query(edges, k_c, k_f))
+    if failures:
+        sys.exit(1)
+    print("All output checks passed")
+
+
+if __name__ == "__main__":
+    main()
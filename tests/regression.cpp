@@ -0,0 +1,347 @@
+#include <mpi.h>
+#include "digraph.h"
+#include "edge_io.h"
+#include "generator.h"
+#include "graph.h"
+#include "intersect.h"
+#include "peeler.h"
+#include "thread_pool.h"
+#include "triangles.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// Single-process regression checks of the counting kernels, the support
+// counter, the triangle index and the bucket peel against simple reference
+// implementations, on the bundled graph and small generated ones. Prints every
+// mismatch and exits nonzero if any.
+
+using namespace std;
+
+static int failures = 0;
+
+static void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "FAILED: " << what << endl;
+        ++failures;
+    }
+}
+
+// Sorted, duplicate-free values drawn from [0, range)
+static vector<int> random_set(mt19937& rng, int len, int range) {
+    uniform_int_distribution<int> pick(0, range - 1);
+    vector<int> values;
+    for (int i = 0; i < len; ++i) {
+        values.push_back(pick(rng));
+    }
+    sort(values.begin(), values.end());
+    values.erase(unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+static int reference_intersection(const vector<int>& a, const vector<int>& b) {
+    vector<int> common;
+    set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(common));
+    return static_cast<int>(common.size());
+}
+
+// Every kernel, on lengths around the vector widths and on skewed pairs that
+// take the galloping path of the dispatcher
+static void check_kernels() {
+    vector<pair<string, IntersectKernel>> kernels = {{"scalar", intersect_count_scalar},
+                                                     {"gallop", intersect_count_gallop},
+                                                     {"dispatched", intersect_count}};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back({"avx2", intersect_count_avx2});
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.push_back({"avx512", intersect_count_avx512});
+    }
+#endif
+    mt19937 rng(7);
+    const int lengths[] = {0, 1, 2, 7, 8, 9, 15, 16, 17, 31, 33, 64, 100, 257, 2000};
+    for (int a_len : lengths) {
+        for (int b_len : lengths) {
+            for (int range : {a_len + b_len + 1, 4 * (a_len + b_len) + 1, 100000}) {
+                vector<int> a = random_set(rng, a_len, range), b = random_set(rng, b_len, range);
+                int expected = reference_intersection(a, b);
+                for (const auto& kernel : kernels) {
+                    int got = kernel.second(a.data(), static_cast<int>(a.size()), b.data(), static_cast<int>(b.size()));
+                    check(got == expected, kernel.first + " kernel on lengths " + to_string(a.size()) + ", " + to_string(b.size()) +
+                                               ": " + to_string(got) + " != " + to_string(expected));
+                }
+            }
+        }
+    }
+
+    // The combined kernel against the four pairwise intersections
+    for (int trial = 0; trial < 500; ++trial) {
+        int range = 1 + trial % 200;
+        vector<int> lists[4];
+        for (auto& list : lists) {
+            list = random_set(rng, static_cast<int>(rng() % 40), range);
+        }
+        NeighborCounts counts = intersect_neighborhoods(lists[0].data(), static_cast<int>(lists[0].size()), lists[1].data(),
+                                                        static_cast<int>(lists[1].size()), lists[2].data(),
+                                                        static_cast<int>(lists[2].size()), lists[3].data(),
+                                                        static_cast<int>(lists[3].size()));
+        check(counts.out_out == reference_intersection(lists[0], lists[2]) &&
+                  counts.out_in == reference_intersection(lists[0], lists[3]) &&
+                  counts.in_out == reference_intersection(lists[1], lists[2]) &&
+                  counts.in_in == reference_intersection(lists[1], lists[3]),
+              "combined kernel, trial " + to_string(trial));
+    }
+}
+
+// Cycle and flow triangles of every live edge of G, from the visitors
+static void reference_supports(const DiGraph& G, const vector<char>* removed, EdgeSupports& supports) {
+    supports.assign(G.num_edges());
+    for (int e = 0; e < G.num_edges(); ++e) {
+        for_each_cycle_triangle(G, e, removed, [&](int, int) { supports.cycle[e]++; });
+        for_each_flow_triangle(G, e, removed, [&](int, int) { supports.flow[e]++; });
+    }
+}
+
+// The oriented one-pass counter and the per-edge kernel against the visitors,
+// on the whole graph, with edges removed, and for the owned edges of a rank
+static void check_supports(const string& name, const DiGraph& G) {
+    int m = G.num_edges();
+    EdgeSupports expected, counted;
+    reference_supports(G, nullptr, expected);
+    compute_supports(G, counted);
+    for (int e = 0; e < m; ++e) {
+        int cycle, flow;
+        count_edge_triangles(G, e, cycle, flow);
+        check(counted.cycle[e] == expected.cycle[e] && counted.flow[e] == expected.flow[e],
+              name + ": oriented supports of edge " + to_string(e));
+        check(cycle == expected.cycle[e] && flow == expected.flow[e], name + ": kernel supports of edge " + to_string(e));
+    }
+
+    mt19937 rng(11);
+    vector<char> removed(m), owned(G.num_vertices);
+    for (auto& r : removed) {
+        r = rng() % 4 == 0;
+    }
+    for (auto& o : owned) {
+        o = rng() % 2;
+    }
+    OrientedGraph O;
+    reference_supports(G, &removed, expected);
+    build_oriented_graph(G, nullptr, &removed, O);
+    counted.assign(m);
+    count_triangle_supports(O, counted.cycle, counted.flow);
+    for (int e = 0; e < m; ++e) {
+        check(removed[e] || (counted.cycle[e] == expected.cycle[e] && counted.flow[e] == expected.flow[e]),
+              name + ": oriented supports of edge " + to_string(e) + " with edges removed");
+    }
+
+    reference_supports(G, nullptr, expected);
+    build_oriented_graph(G, &owned, nullptr, O);
+    counted.assign(m);
+    count_triangle_supports(O, counted.cycle, counted.flow);
+    for (int e = 0; e < m; ++e) {
+        check(!owned[G.source(e)] || (counted.cycle[e] == expected.cycle[e] && counted.flow[e] == expected.flow[e]),
+              name + ": oriented supports of owned edge " + to_string(e));
+    }
+}
+
+typedef vector<pair<int, int>> PartnerList;
+
+template <typename Visit>
+static PartnerList sorted_partners(const DiGraph& G, int e, const vector<char>* removed, Visit visit) {
+    PartnerList partners;
+    visit(G, e, removed, [&](int e1, int e2) { partners.push_back({e1, e2}); });
+    sort(partners.begin(), partners.end());
+    return partners;
+}
+
+// Lists read through the index against the visitors, for every live edge
+static void compare_index(const string& what, const DiGraph& G, const TriangleIndex& index, const vector<char>* removed) {
+    IndexedCycleTriangles indexed_cycle = {&index};
+    IndexedFlowTriangles indexed_flow = {&index};
+    for (int e = 0; e < G.num_edges(); ++e) {
+        if (removed && (*removed)[e]) {
+            continue;
+        }
+        check(sorted_partners(G, e, removed, indexed_cycle) == sorted_partners(G, e, removed, CycleTriangles()) &&
+                  sorted_partners(G, e, removed, indexed_flow) == sorted_partners(G, e, removed, FlowTriangles()),
+              what + ": triangles of edge " + to_string(e));
+    }
+}
+
+// The index with room for every list, over a graph with edges removed, read
+// with edges removed afterwards, under a budget that leaves edges out, and as
+// filled by the support-counting pass of a single-rank distributed graph
+static void check_index(const string& name, const DiGraph& G) {
+    int m = G.num_edges();
+    const long long unlimited = 1LL << 40;
+    TriangleIndex index;
+    build_triangle_index(G, nullptr, unlimited, index);
+    check(count(index.indexed.begin(), index.indexed.end(), 1) == m, name + ": unlimited index leaves edges out");
+    compare_index(name + ", full index", G, index, nullptr);
+
+    mt19937 rng(13);
+    vector<char> removed(m);
+    for (auto& r : removed) {
+        r = rng() % 4 == 0;
+    }
+    compare_index(name + ", full index read with edges removed", G, index, &removed);
+    build_triangle_index(G, &removed, unlimited, index);
+    compare_index(name + ", index of the live edges", G, index, &removed);
+
+    long long list_bytes = 0;
+    EdgeSupports supports;
+    compute_supports(G, supports);
+    for (int e = 0; e < m; ++e) {
+        list_bytes += 8LL * (supports.cycle[e] + supports.flow[e]);
+    }
+    build_triangle_index(G, nullptr, 16LL * (m + 1) + list_bytes / 2, index);
+    if (list_bytes > 0) {
+        check(count(index.indexed.begin(), index.indexed.end(), 1) < m, name + ": half budget indexes every edge");
+    }
+    compare_index(name + ", half budget", G, index, nullptr);
+
+    // The same arcs through the owner layout of one rank
+    vector<pair<VertexId, VertexId>> arcs;
+    for (int e = 0; e < m; ++e) {
+        arcs.push_back({G.labels[G.source(e)], G.labels[G.target(e)]});
+    }
+    DistGraph D;
+    distribute_graph(arcs, 0, 1, D);
+    EdgeSupports counted;
+    counted.assign(D.local.num_edges());
+    compute_supports(D, counted, &index, unlimited);
+    check(static_cast<int>(D.owned_edges.size()) == D.local.num_edges(), name + ": single rank does not own every edge");
+    compare_index(name + ", index of the counting pass", D.local, index, nullptr);
+}
+
+// Trussness by definition: the largest k such that the edge survives in the
+// subgraph left after repeatedly dropping every edge with fewer than k triangles
+template <typename Visit>
+static vector<int> reference_trussness(const DiGraph& G, Visit visit) {
+    int m = G.num_edges();
+    vector<int> trussness(m, 0);
+    vector<char> removed(m, 0);
+    int live = m;
+    for (int k = 1; live > 0; ++k) {
+        vector<int> dropped;
+        do {
+            dropped.clear();
+            for (int e = 0; e < m; ++e) {
+                int triangles = 0;
+                if (!removed[e]) {
+                    visit(G, e, &removed, [&](int, int) { ++triangles; });
+                    if (triangles < k) {
+                        dropped.push_back(e);
+                    }
+                }
+            }
+            for (int e : dropped) {
+                removed[e] = 1;
+            }
+            live -= static_cast<int>(dropped.size());
+        } while (!dropped.empty());
+        for (int e = 0; e < m; ++e) {
+            if (!removed[e]) {
+                trussness[e] = k;
+            }
+        }
+    }
+    return trussness;
+}
+
+// compute_trussness on the supports of compute_supports, with and without an
+// index, and resumed from progress saved between levels
+static void check_trussness(const string& name, const DiGraph& G) {
+    vector<int> expected_cycle = reference_trussness(G, CycleTriangles());
+    vector<int> expected_flow = reference_trussness(G, FlowTriangles());
+    auto compare = [&](const string& what, const PeelProgress& progress) {
+        check(progress.values.cycle == expected_cycle && progress.values.flow == expected_flow, name + ": trussness " + what);
+    };
+
+    EdgeSupports supports;
+    compute_supports(G, supports);
+    PeelProgress progress;
+    progress.values = supports;
+    compute_trussness(G, progress, 0, 0);
+    compare("of the bucket peel", progress);
+
+    TriangleIndex index;
+    build_triangle_index(G, nullptr, 1LL << 40, index);
+    progress = PeelProgress();
+    progress.values = supports;
+    compute_trussness(G, progress, 0, 0, &index);
+    compare("of the indexed bucket peel", progress);
+
+    vector<PeelProgress> saved;
+    int calls = 0;
+    progress = PeelProgress();
+    progress.values = supports;
+    int k_c_max = *max_element(supports.cycle.begin(), supports.cycle.end());
+    int k_f_max = *max_element(supports.flow.begin(), supports.flow.end());
+    compute_trussness(G, progress, k_c_max, k_f_max, nullptr, [&](const PeelProgress& p) {
+        if (calls++ % 5 == 0) {
+            saved.push_back(p);
+        }
+    });
+    compare("of the bucket peel with a level hook", progress);
+    check(calls == k_c_max + k_f_max + 2, name + ": level hook called " + to_string(calls) + " times");
+    for (auto& resumed : saved) {
+        string what = "resumed at levels " + to_string(resumed.cycle_level) + ", " + to_string(resumed.flow_level);
+        compute_trussness(G, resumed, 0, 0);
+        compare(what, resumed);
+    }
+}
+
+static void load_graph(const string& filename, DiGraph& G) {
+    vector<pair<VertexId, VertexId>> arcs;
+    read_text_edges(filename, 0, 1, arcs);
+    build_digraph(arcs, G);
+}
+
+static void generate_graph(const string& model, int scale, int edge_factor, double reciprocity, DiGraph& G) {
+    GeneratorConfig config;
+    config.model = model;
+    config.scale = scale;
+    config.edge_factor = edge_factor;
+    config.reciprocity = reciprocity;
+    vector<pair<VertexId, VertexId>> arcs;
+    generate_arcs(config, 0, 1, arcs);
+    build_digraph(arcs, G);
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    // Bundled graph, relative to src by default
+    string input = argc > 1 ? argv[1] : "../data/graph.e";
+
+    check_kernels();
+
+    vector<pair<string, DiGraph>> graphs(3);
+    graphs[0].first = input;
+    load_graph(input, graphs[0].second);
+    graphs[1].first = "rmat scale 8";
+    generate_graph("rmat", 8, 8, 0.3, graphs[1].second);
+    graphs[2].first = "er scale 8";
+    generate_graph("er", 8, 6, 0.4, graphs[2].second);
+    for (int threads : {1, 4}) {
+        init_thread_pool(threads);
+        for (const auto& graph : graphs) {
+            check_supports(graph.first, graph.second);
+            check_index(graph.first, graph.second);
+            check_trussness(graph.first, graph.second);
+        }
+    }
+
+    if (failures == 0) {
+        cout << "All regression checks passed" << endl;
+    }
+    MPI_Finalize();
+    return failures == 0 ? 0 : 1;
+}